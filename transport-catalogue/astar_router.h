@@ -0,0 +1,155 @@
+/*!
+ * @file astar_router.h
+ * @brief Заголовочный файл с поиском кратчайших путей по запросу (алгоритм A*)
+ *
+ * Как и graph::DijkstraRouter, не требует предварительных вычислений, но упорядочивает
+ * вершины по сумме найденного веса и нижней оценки оставшегося пути (эвристики),
+ * поэтому просматривает в основном вершины "в сторону" цели.
+ * Эвристика должна быть согласованной: heuristic(u, to) <= weight(u, v) + heuristic(v, to)
+ * для каждого ребра u -> v, иначе найденный путь может оказаться не кратчайшим.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/*!
+ * Heuristic - функциональный объект Weight(VertexId vertex, VertexId to),
+ * нижняя оценка веса пути из vertex в to
+ */
+template <typename Weight, typename Heuristic>
+class AStarRouter : public BaseRouter<Weight> {
+private:
+    using Graph = typename BaseRouter<Weight>::Graph;
+
+public:
+    using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+    AStarRouter(const Graph& graph, Heuristic heuristic);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    const Graph& GetGraph() const override;
+
+    const Heuristic& GetHeuristic() const;
+
+private:
+    /// Элемент очереди поиска: оценка полного пути, найденный вес и вершина
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    Heuristic heuristic_;
+};
+
+template <typename Weight, typename Heuristic>
+AStarRouter<Weight, Heuristic>::AStarRouter(const Graph& graph, Heuristic heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight, typename Heuristic>
+const typename AStarRouter<Weight, Heuristic>::Graph& AStarRouter<Weight, Heuristic>::GetGraph() const {
+    return graph_;
+}
+
+template <typename Weight, typename Heuristic>
+const Heuristic& AStarRouter<Weight, Heuristic>::GetHeuristic() const {
+    return heuristic_;
+}
+
+template <typename Weight, typename Heuristic>
+std::optional<typename AStarRouter<Weight, Heuristic>::RouteInfo>
+AStarRouter<Weight, Heuristic>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<std::optional<Weight>> weights(vertex_count);
+    std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+    // эвристика считается только для вершин, до которых дошел поиск
+    std::vector<std::optional<Weight>> estimates(vertex_count);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    auto estimate = [&](VertexId vertex) {
+        auto& vertex_estimate = estimates[vertex];
+        if (!vertex_estimate) {
+            vertex_estimate = heuristic_(vertex, to);
+        }
+        return *vertex_estimate;
+    };
+
+    weights[from] = ZERO_WEIGHT;
+    queue.push({estimate(from), ZERO_WEIGHT, from});
+
+    while (!queue.empty()) {
+        const auto [priority, weight, vertex] = queue.top();
+        queue.pop();
+
+        // в очереди могут остаться устаревшие записи о уже улучшенных вершинах
+        if (*weights[vertex] < weight) {
+            continue;
+        }
+        if (vertex == to) {
+            break;
+        }
+
+        auto relax = [&, weight = weight](EdgeId edge_id, VertexId target, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            auto& target_weight = weights[target];
+            if (!target_weight || candidate_weight < *target_weight) {
+                target_weight = candidate_weight;
+                prev_edges[target] = edge_id;
+                queue.push({candidate_weight + estimate(target), candidate_weight, target});
+            }
+        };
+
+        if (graph_.IsFrozen()) {
+            const size_t arc_end = graph_.GetArcEnd(vertex);
+            for (size_t arc = graph_.GetArcBegin(vertex); arc < arc_end; ++arc) {
+                relax(graph_.GetArcEdge(arc), graph_.GetArcTarget(arc), graph_.GetArcWeight(arc));
+            }
+        } else {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(edge_id, graph_.GetEdgeTo(edge_id), graph_.GetEdgeWeight(edge_id));
+            }
+        }
+    }
+
+    if (!weights[to]) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdgeFrom(*prev_edges[vertex])) {
+        edges.push_back(*prev_edges[vertex]);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{*weights[to], std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,146 @@
+/*!
+ * @file route_bench.cpp
+ * @brief Замер времени подготовки движка маршрутов и ответа на запросы Route
+ * на сгенерированной сети остановок
+ *
+ * Остановки стоят в узлах квадратной решетки в 400 м друг от друга, некольцевые маршруты
+ * идут отрезками по SEGMENT_LENGTH остановок вдоль строк и столбцов решетки и пересекаются
+ * на общих остановках. Пары остановок для запросов выбираются случайно с фиксированным seed.
+ *
+ * Использование: route_bench <stop_count> [router_type] [query_count] [graph_model]
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "serialization.h"
+#include "transport_catalogue.h"
+
+using namespace std::literals;
+
+namespace {
+
+/// Количество остановок в одном маршруте
+constexpr size_t SEGMENT_LENGTH = 8;
+
+std::string GetStopName(size_t row, size_t column, size_t side) {
+    return "S"s + std::to_string(row * side + column);
+}
+
+/*!
+ * Формирует входные данные make_base для решетки side x side
+ *
+ * @param side количество остановок в строке решетки
+ * @param router_type движок маршрутов
+ * @param graph_model модель графа маршрутов
+ *
+ * @return json с base_requests и routing_settings
+ */
+std::string MakeGridBase(size_t side, const std::string& router_type, const std::string& graph_model) {
+    std::ostringstream out;
+    out.precision(8);
+    out << R"({"base_requests": [)";
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t column = 0; column < side; ++column) {
+            out << R"({"type": "Stop", "name": ")" << GetStopName(row, column, side)
+                << R"(", "latitude": )" << 55.5 + row * 0.0036 << R"(, "longitude": )" << 37.3 + column * 0.0064
+                << R"(, "road_distances": {)";
+            if (column + 1 < side) {
+                out << '"' << GetStopName(row, column + 1, side) << R"(": 400)";
+            }
+            if (row + 1 < side) {
+                out << (column + 1 < side ? ", " : "") << '"' << GetStopName(row + 1, column, side) << R"(": 400)";
+            }
+            out << "}},";
+        }
+    }
+
+    // соседние маршруты одной линии делят крайнюю остановку, чтобы по линии можно было проехать с пересадкой
+    size_t bus_count = 0;
+    auto add_bus = [&](auto get_stop) {
+        for (size_t begin = 0; begin + 1 < side; begin += SEGMENT_LENGTH - 1) {
+            const size_t end = std::min(begin + SEGMENT_LENGTH, side);
+            out << R"({"type": "Bus", "name": "B)" << bus_count++ << R"(", "is_roundtrip": false, "stops": [)";
+            for (size_t i = begin; i < end; ++i) {
+                out << (i == begin ? "" : ", ") << '"' << get_stop(i) << '"';
+            }
+            out << "]},";
+        }
+    };
+    for (size_t line = 0; line < side; ++line) {
+        add_bus([&](size_t i) { return GetStopName(line, i, side); });
+        add_bus([&](size_t i) { return GetStopName(i, line, side); });
+    }
+    out.seekp(-1, std::ios_base::cur);
+
+    out << R"(], "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30, "router_type": ")" << router_type
+        << R"(", "graph_model": ")" << graph_model << R"("}})";
+    return out.str();
+}
+
+double GetMilliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 5) {
+        std::cerr << "Usage: route_bench <stop_count> [router_type] [query_count] [graph_model]\n";
+        return 1;
+    }
+    const size_t side = static_cast<size_t>(std::ceil(std::sqrt(std::stod(argv[1]))));
+    const std::string router_type = argc > 2 ? argv[2] : "floyd_warshall"s;
+    const size_t query_count = argc > 3 ? std::stoul(argv[3]) : 1000;
+    const std::string graph_model = argc > 4 ? argv[4] : "stop_pairs"s;
+
+    catalog::TransportCatalogue catalog;
+    map_renderer::MapRanderer map;
+    serialization::Serialization serialization;
+
+    // движок маршрутов готовится так же, как в make_base, но без записи базы
+    const auto build_start = std::chrono::steady_clock::now();
+    std::istringstream input(MakeGridBase(side, router_type, graph_model));
+    MakeBaseJSON(catalog, map, serialization, input);
+    RequestHandler handler(catalog, map, catalog.GetGraph(), serialization);
+    const auto build_time = std::chrono::steady_clock::now() - build_start;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> stop_distribution(0, side * side - 1);
+    std::chrono::steady_clock::duration total_time{};
+    std::chrono::steady_clock::duration max_time{};
+    size_t found = 0;
+    for (size_t i = 0; i < query_count; ++i) {
+        const size_t from = stop_distribution(generator);
+        const size_t to = stop_distribution(generator);
+        const std::string from_name = GetStopName(from / side, from % side, side);
+        const std::string to_name = GetStopName(to / side, to % side, side);
+
+        const auto query_start = std::chrono::steady_clock::now();
+        const auto route = handler.GetRouter(from_name, to_name);
+        const auto query_time = std::chrono::steady_clock::now() - query_start;
+
+        total_time += query_time;
+        max_time = std::max(max_time, query_time);
+        found += route.has_value();
+    }
+
+    std::cout << "stops: " << side * side << ", edges: " << catalog.GetGraph().GetEdgeCount() << '\n'
+              << "build: " << GetMilliseconds(build_time) << " ms\n"
+              << "queries: " << query_count << ", found: " << found
+              << ", avg: " << (query_count ? GetMilliseconds(total_time) / query_count : 0.0) << " ms"
+              << ", max: " << GetMilliseconds(max_time) << " ms\n";
+    return 0;
+}
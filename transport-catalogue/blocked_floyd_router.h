@@ -0,0 +1,351 @@
+/*!
+ * @file blocked_floyd_router.h
+ * @brief Заголовочный файл с блочным параллельным алгоритмом Флойда-Уоршелла
+ *
+ * Таблица путей для всех пар вершин хранится в двух плоских матрицах
+ * vertex_count x vertex_count: весов (бесконечность - пути нет) и 32-битных номеров
+ * последних ребер пути. Веса в таблице могут храниться в типе StoredWeight меньшей точности
+ * (например, float вместо double), тогда вес найденного маршрута пересчитывается по его ребрам.
+ * Матрица обрабатывается блоками BLOCK_SIZE x BLOCK_SIZE, которые помещаются в кэш,
+ * независимые блоки каждой фазы обрабатываются в нескольких потоках.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include "router.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/// Плоская таблица кратчайших путей: строка from, столбец to, ячейка from * vertex_count + to
+template <typename StoredWeight>
+struct RoutesTable {
+    using PrevEdge = std::uint32_t;
+
+    /// Последнее ребро пути отсутствует (пути нет или from == to)
+    static constexpr PrevEdge NO_EDGE = std::numeric_limits<PrevEdge>::max();
+
+    size_t vertex_count = 0;
+    std::vector<StoredWeight> weights;      ///< Вес пути, бесконечность - пути нет
+    std::vector<PrevEdge> prev_edges;       ///< Последнее ребро пути или NO_EDGE
+};
+
+template <typename Weight, typename StoredWeight = Weight>
+class BlockedFloydRouter : public BaseRouter<Weight> {
+private:
+    using Graph = typename BaseRouter<Weight>::Graph;
+
+public:
+    using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+    using Table = RoutesTable<StoredWeight>;
+    using PrevEdge = typename Table::PrevEdge;
+
+    explicit BlockedFloydRouter(const Graph& graph);
+
+    /// Конструктор от заранее посчитанной таблицы путей (например, загруженной из базы)
+    BlockedFloydRouter(const Graph& graph, Table table);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<Weight>> BuildRouteWeights(VertexId from, const std::vector<VertexId>& to) const override;
+
+    bool CanUpdateEdgeWeights() const override {
+        return true;
+    }
+
+    /*!
+     * Строки таблицы с путями через увеличенные ребра считаются заново поиском Дейкстры,
+     * уменьшение весов учитывается на месте за O(V^2) на ребро
+     */
+    bool UpdateEdgeWeights(const std::vector<EdgeWeightChange<Weight>>& changes) override;
+
+    const Graph& GetGraph() const override;
+
+    /// Таблица кратчайших путей между всеми парами вершин
+    const Table& GetRoutesTable() const;
+
+private:
+    /// Размер блока: три блока весов и ребер умещаются в кэше L2
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr StoredWeight INFINITE_WEIGHT = std::numeric_limits<StoredWeight>::infinity();
+
+    void InitializeTable();
+
+    /*!
+     * Релаксирует пути блока (block_row, block_column) через вершины блока block_through
+     *
+     * Внешний цикл по промежуточной вершине, поэтому функция корректна и для блоков,
+     * лежащих в строке или столбце block_through. Внутренний цикл без ветвлений
+     * по непрерывным участкам строк и векторизуется компилятором.
+     */
+    void RelaxBlock(size_t block_row, size_t block_column, size_t block_through);
+
+    const Graph& graph_;
+    Table table_;
+};
+
+template <typename Weight, typename StoredWeight>
+BlockedFloydRouter<Weight, StoredWeight>::BlockedFloydRouter(const Graph& graph)
+    : graph_(graph)
+{
+    static_assert(std::numeric_limits<StoredWeight>::has_infinity, "Stored weight should have an infinity value");
+
+    InitializeTable();
+
+    const size_t block_count = (table_.vertex_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (size_t block_through = 0; block_through < block_count; ++block_through) {
+        // фаза 1: диагональный блок зависит только от себя
+        RelaxBlock(block_through, block_through, block_through);
+
+        // фаза 2: блоки строки и столбца block_through зависят от себя и диагонального блока
+        parallel::ForEachRange(2 * block_count, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const size_t block = i / 2;
+                if (block == block_through) {
+                    continue;
+                }
+                if (i % 2 == 0) {
+                    RelaxBlock(block_through, block, block_through);
+                } else {
+                    RelaxBlock(block, block_through, block_through);
+                }
+            }
+        });
+
+        // фаза 3: остальные блоки зависят только от блоков строки и столбца block_through
+        parallel::ForEachRange(block_count, [&](size_t, size_t begin, size_t end) {
+            for (size_t block_row = begin; block_row < end; ++block_row) {
+                if (block_row == block_through) {
+                    continue;
+                }
+                for (size_t block_column = 0; block_column < block_count; ++block_column) {
+                    if (block_column != block_through) {
+                        RelaxBlock(block_row, block_column, block_through);
+                    }
+                }
+            }
+        });
+    }
+}
+
+template <typename Weight, typename StoredWeight>
+BlockedFloydRouter<Weight, StoredWeight>::BlockedFloydRouter(const Graph& graph, Table table)
+    : graph_(graph)
+    , table_(std::move(table))
+{
+    const size_t cell_count = table_.vertex_count * table_.vertex_count;
+    if (table_.vertex_count != graph.GetVertexCount() || table_.weights.size() != cell_count
+        || table_.prev_edges.size() != cell_count) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+}
+
+template <typename Weight, typename StoredWeight>
+void BlockedFloydRouter<Weight, StoredWeight>::InitializeTable() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    table_.vertex_count = vertex_count;
+    table_.weights.assign(vertex_count * vertex_count, INFINITE_WEIGHT);
+    table_.prev_edges.assign(vertex_count * vertex_count, Table::NO_EDGE);
+
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        table_.weights[vertex * vertex_count + vertex] = StoredWeight{};
+    }
+
+    const size_t edge_count = graph_.GetEdgeCount();
+    if (edge_count >= Table::NO_EDGE) {
+        throw std::length_error("Too many edges for the routes table");
+    }
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        const size_t cell = edge.from * vertex_count + edge.to;
+        const StoredWeight edge_weight = static_cast<StoredWeight>(edge.weight);
+        if (edge_weight < table_.weights[cell]) {
+            table_.weights[cell] = edge_weight;
+            table_.prev_edges[cell] = static_cast<PrevEdge>(edge_id);
+        }
+    }
+}
+
+template <typename Weight, typename StoredWeight>
+void BlockedFloydRouter<Weight, StoredWeight>::RelaxBlock(size_t block_row, size_t block_column, size_t block_through) {
+    const size_t vertex_count = table_.vertex_count;
+    const size_t row_begin = block_row * BLOCK_SIZE;
+    const size_t row_end = std::min(row_begin + BLOCK_SIZE, vertex_count);
+    const size_t column_begin = block_column * BLOCK_SIZE;
+    const size_t column_end = std::min(column_begin + BLOCK_SIZE, vertex_count);
+    const size_t through_begin = block_through * BLOCK_SIZE;
+    const size_t through_end = std::min(through_begin + BLOCK_SIZE, vertex_count);
+    const size_t width = column_end - column_begin;
+
+    StoredWeight* weights = table_.weights.data();
+    PrevEdge* prev_edges = table_.prev_edges.data();
+
+    for (size_t through = through_begin; through < through_end; ++through) {
+        const StoredWeight* through_weights = weights + through * vertex_count + column_begin;
+        const PrevEdge* through_prev_edges = prev_edges + through * vertex_count + column_begin;
+
+        for (size_t row = row_begin; row < row_end; ++row) {
+            const StoredWeight weight_to_through = weights[row * vertex_count + through];
+            if (weight_to_through == INFINITE_WEIGHT) {
+                continue;
+            }
+            StoredWeight* row_weights = weights + row * vertex_count + column_begin;
+            PrevEdge* row_prev_edges = prev_edges + row * vertex_count + column_begin;
+
+            for (size_t column = 0; column < width; ++column) {
+                const StoredWeight candidate_weight = weight_to_through + through_weights[column];
+                const bool is_better = candidate_weight < row_weights[column];
+                row_weights[column] = is_better ? candidate_weight : row_weights[column];
+                row_prev_edges[column] = is_better ? through_prev_edges[column] : row_prev_edges[column];
+            }
+        }
+    }
+}
+
+template <typename Weight, typename StoredWeight>
+bool BlockedFloydRouter<Weight, StoredWeight>::UpdateEdgeWeights(const std::vector<EdgeWeightChange<Weight>>& changes) {
+    const size_t vertex_count = table_.vertex_count;
+    auto& weights = table_.weights;
+    auto& prev_edges = table_.prev_edges;
+
+    // строки, пути которых не проходят через увеличенные ребра, остаются кратчайшими
+    const std::vector<bool> is_stale = FindRowsWithIncreasedEdges(graph_, changes, [&](VertexId from, VertexId to) {
+        const PrevEdge prev_edge = prev_edges[from * vertex_count + to];
+        return prev_edge == Table::NO_EDGE ? std::nullopt : std::optional<EdgeId>(prev_edge);
+    });
+    parallel::ForEachRange(vertex_count, [&](size_t, size_t begin, size_t end) {
+        std::vector<std::optional<Weight>> route_weights(vertex_count);
+        std::vector<std::optional<EdgeId>> route_prev_edges(vertex_count);
+        for (VertexId from = begin; from < end; ++from) {
+            if (!is_stale[from]) {
+                continue;
+            }
+            std::fill(route_weights.begin(), route_weights.end(), std::nullopt);
+            std::fill(route_prev_edges.begin(), route_prev_edges.end(), std::nullopt);
+            SearchShortestPaths(graph_, from, route_weights, route_prev_edges, [](VertexId) {
+                return false;
+            });
+            const size_t row = from * vertex_count;
+            for (VertexId to = 0; to < vertex_count; ++to) {
+                weights[row + to] = route_weights[to] ? static_cast<StoredWeight>(*route_weights[to]) : INFINITE_WEIGHT;
+                prev_edges[row + to] = route_prev_edges[to] ? static_cast<PrevEdge>(*route_prev_edges[to]) : Table::NO_EDGE;
+            }
+        }
+    });
+
+    // путь a -> b через уменьшенное ребро u -> v: a -> u, ребро, v -> b; столбец u и строка v не меняются
+    for (const auto& change : changes) {
+        const auto edge = graph_.GetEdge(change.edge_id);
+        if (!(edge.weight < change.old_weight)) {
+            continue;
+        }
+        const size_t row_from_edge = edge.to * vertex_count;
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            const size_t row = vertex_from * vertex_count;
+            if (weights[row + edge.from] == INFINITE_WEIGHT) {
+                continue;
+            }
+            const StoredWeight weight_to_edge = weights[row + edge.from] + static_cast<StoredWeight>(edge.weight);
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                const StoredWeight candidate_weight = weight_to_edge + weights[row_from_edge + vertex_to];
+                if (candidate_weight < weights[row + vertex_to]) {
+                    weights[row + vertex_to] = candidate_weight;
+                    const PrevEdge prev_edge = prev_edges[row_from_edge + vertex_to];
+                    prev_edges[row + vertex_to] = prev_edge != Table::NO_EDGE ? prev_edge : static_cast<PrevEdge>(change.edge_id);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Weight, typename StoredWeight>
+const typename BlockedFloydRouter<Weight, StoredWeight>::Graph& BlockedFloydRouter<Weight, StoredWeight>::GetGraph() const {
+    return graph_;
+}
+
+template <typename Weight, typename StoredWeight>
+const typename BlockedFloydRouter<Weight, StoredWeight>::Table& BlockedFloydRouter<Weight, StoredWeight>::GetRoutesTable() const {
+    return table_;
+}
+
+template <typename Weight, typename StoredWeight>
+std::vector<std::optional<Weight>> BlockedFloydRouter<Weight, StoredWeight>::BuildRouteWeights(VertexId from,
+                                                                                             const std::vector<VertexId>& to) const {
+    if constexpr (!std::is_same_v<Weight, StoredWeight>) {
+        // точный вес пересчитывается по ребрам маршрута
+        return BaseRouter<Weight>::BuildRouteWeights(from, to);
+    } else {
+        const size_t vertex_count = table_.vertex_count;
+        if (from >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const StoredWeight* row = table_.weights.data() + from * vertex_count;
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(to.size());
+        for (const VertexId vertex_to : to) {
+            if (vertex_to >= vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            if (row[vertex_to] == INFINITE_WEIGHT) {
+                weights.push_back(std::nullopt);
+            } else {
+                weights.push_back(row[vertex_to]);
+            }
+        }
+        return weights;
+    }
+}
+
+template <typename Weight, typename StoredWeight>
+std::optional<typename BlockedFloydRouter<Weight, StoredWeight>::RouteInfo>
+BlockedFloydRouter<Weight, StoredWeight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = table_.vertex_count;
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    const size_t row = from * vertex_count;
+    if (table_.weights[row + to] == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (PrevEdge edge_id = table_.prev_edges[row + to];
+         edge_id != Table::NO_EDGE;
+         edge_id = table_.prev_edges[row + graph_.GetEdgeFrom(edge_id)])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    if constexpr (std::is_same_v<Weight, StoredWeight>) {
+        return RouteInfo{table_.weights[row + to], std::move(edges)};
+    } else {
+        // вес в таблице округлен до StoredWeight, точный вес - сумма весов ребер маршрута
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdgeWeight(edge_id);
+        }
+        return RouteInfo{weight, std::move(edges)};
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,108 @@
+#include "connection_scan.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+using namespace connection_scan;
+
+ConnectionScanRouter::ConnectionScanRouter(const std::vector<const domain::Bus*>& buses) {
+    for (auto bus : buses) {
+        const size_t trip_stop_count = bus->GetTripStopCount();
+        for (size_t first = 0; first + trip_stop_count <= bus->timetable.size(); first += trip_stop_count) {
+            const auto trip = static_cast<std::uint32_t>(trip_buses_.size());
+            trip_buses_.push_back(bus);
+
+            for (size_t i = 0; i + 1 < trip_stop_count; ++i) {
+                Connection connection;
+                connection.from = static_cast<std::uint32_t>(bus->GetTripStop(i)->stop_id);
+                connection.to = static_cast<std::uint32_t>(bus->GetTripStop(i + 1)->stop_id);
+                connection.departure = bus->timetable[first + i];
+                connection.arrival = bus->timetable[first + i + 1];
+                connection.trip = trip;
+                connection.trip_stop = static_cast<std::uint32_t>(i);
+                connections_.push_back(connection);
+
+                stop_count_ = std::max<size_t>(stop_count_, std::max(connection.from, connection.to) + 1);
+            }
+        }
+    }
+
+    std::sort(connections_.begin(), connections_.end(), [](const Connection& lhs, const Connection& rhs) {
+        return std::tie(lhs.departure, lhs.arrival, lhs.trip, lhs.trip_stop)
+             < std::tie(rhs.departure, rhs.arrival, rhs.trip, rhs.trip_stop);
+    });
+}
+
+std::optional<Journey> ConnectionScanRouter::BuildJourney(size_t from, size_t to, int departure_time) const {
+    if (from == to) {
+        return Journey{static_cast<double>(departure_time), {}};
+    }
+    if (from >= stop_count_ || to >= stop_count_) {
+        return std::nullopt;
+    }
+
+    constexpr std::int32_t NOT_REACHED = std::numeric_limits<std::int32_t>::max();
+    constexpr std::uint32_t NO_CONNECTION = std::numeric_limits<std::uint32_t>::max();
+
+    /// Последняя поездка до остановки: перегоны посадки и высадки
+    struct Arrival {
+        std::uint32_t boarding = NO_CONNECTION;
+        std::uint32_t alighting = NO_CONNECTION;
+    };
+
+    std::vector<std::int32_t> earliest_arrivals(stop_count_, NOT_REACHED);
+    std::vector<Arrival> arrivals(stop_count_);
+    std::vector<std::uint32_t> trip_boardings(trip_buses_.size(), NO_CONNECTION);
+    earliest_arrivals[from] = departure_time;
+
+    auto first = std::lower_bound(connections_.begin(), connections_.end(), departure_time,
+        [](const Connection& connection, int time) {
+            return connection.departure < time;
+        });
+
+    for (auto it = first; it != connections_.end(); ++it) {
+        const Connection& connection = *it;
+        // перегоны упорядочены по отправлению, позже уже не приехать раньше
+        if (earliest_arrivals[to] <= connection.departure) {
+            break;
+        }
+
+        auto& trip_boarding = trip_boardings[connection.trip];
+        if (trip_boarding == NO_CONNECTION) {
+            if (earliest_arrivals[connection.from] > connection.departure) {
+                continue;
+            }
+            trip_boarding = static_cast<std::uint32_t>(it - connections_.begin());
+        }
+
+        if (connection.arrival < earliest_arrivals[connection.to]) {
+            earliest_arrivals[connection.to] = connection.arrival;
+            arrivals[connection.to] = {trip_boarding, static_cast<std::uint32_t>(it - connections_.begin())};
+        }
+    }
+
+    if (earliest_arrivals[to] == NOT_REACHED) {
+        return std::nullopt;
+    }
+
+    Journey journey;
+    journey.arrival_time = earliest_arrivals[to];
+    for (size_t stop = to; stop != from; ) {
+        const Connection& boarding = connections_[arrivals[stop].boarding];
+        const Connection& alighting = connections_[arrivals[stop].alighting];
+
+        Leg leg;
+        leg.board_stop = boarding.from;
+        leg.bus = trip_buses_[boarding.trip];
+        leg.span_count = static_cast<int>(alighting.trip_stop - boarding.trip_stop + 1);
+        leg.wait_time = boarding.departure - earliest_arrivals[boarding.from];
+        leg.time = alighting.arrival - boarding.departure;
+        journey.legs.push_back(leg);
+
+        stop = boarding.from;
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+
+    return journey;
+}
@@ -0,0 +1,74 @@
+/*!
+ * @file connection_scan.h
+ * @brief Заголовочный файл с поиском маршрутов по расписанию (Connection Scan Algorithm)
+ *
+ * Каждый рейс маршрута с расписанием разбивается на перегоны (connections):
+ * отправление с остановки и прибытие на следующую. Перегоны упорядочены по времени
+ * отправления, запрос просматривает их один раз, начиная с момента отправления,
+ * и находит маршрут с самым ранним прибытием.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "domain.h"
+
+namespace connection_scan {
+
+/// Поездка на одном рейсе
+struct Leg {
+    size_t board_stop;                  ///< Номер остановки посадки
+    const domain::Bus* bus;             ///< Маршрут рейса
+    int span_count;                     ///< Количество проезжаемых перегонов
+    double wait_time;                   ///< Ожидание рейса на остановке посадки (мин.)
+    double time;                        ///< Время в пути на рейсе (мин.)
+};
+
+/// Маршрут по расписанию
+struct Journey {
+    double arrival_time;                ///< Время прибытия (мин. от начала суток)
+    std::vector<Leg> legs;
+};
+
+class ConnectionScanRouter {
+public:
+    ConnectionScanRouter() = default;
+
+    /// Строит перегоны всех рейсов маршрутов buses (у каждого должно быть задано расписание)
+    explicit ConnectionScanRouter(const std::vector<const domain::Bus*>& buses);
+
+    /*!
+     * Ищет маршрут с самым ранним прибытием
+     *
+     * @param from номер остановки отправления
+     * @param to номер остановки прибытия
+     * @param departure_time время отправления (мин. от начала суток)
+     *
+     * @return маршрут или std::nullopt, если по расписанию доехать нельзя
+     */
+    std::optional<Journey> BuildJourney(size_t from, size_t to, int departure_time) const;
+
+private:
+    /// Перегон рейса: отправление с остановки trip_stop рейса trip и прибытие на следующую
+    struct Connection {
+        std::uint32_t from;
+        std::uint32_t to;
+        std::int32_t departure;
+        std::int32_t arrival;
+        std::uint32_t trip;
+        std::uint32_t trip_stop;
+    };
+
+    std::vector<Connection> connections_;           ///< Упорядочены по времени отправления и прибытия
+    std::vector<const domain::Bus*> trip_buses_;    ///< Маршрут каждого рейса
+    size_t stop_count_ = 0;                         ///< Наибольший номер остановки в расписании + 1
+};
+
+}  // namespace connection_scan
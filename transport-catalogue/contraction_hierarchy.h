@@ -0,0 +1,480 @@
+/*!
+ * @file contraction_hierarchy.h
+ * @brief Заголовочный файл с поиском кратчайших путей по иерархии сжатия графа (contraction hierarchies)
+ *
+ * На этапе предварительной обработки вершины графа по очереди "сжимаются": вершина получает
+ * ранг, а пути через нее, для которых нет обходного пути не длиннее, заменяются ребрами-сокращениями.
+ * Запрос выполняется двунаправленным поиском Дейкстры только по ребрам, ведущим к вершинам
+ * большего ранга, после чего сокращения разворачиваются в исходные ребра графа.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/// Ребро-сокращение, заменяющее путь из двух ребер иерархии first и second
+template <typename Weight>
+struct Shortcut {
+    VertexId from;                                            ///< Вершина начала
+    VertexId to;                                              ///< Вершина конца
+    Weight weight;                                            ///< Суммарный вес заменяемого пути
+    EdgeId first;                                             ///< Первое заменяемое ребро иерархии
+    EdgeId second;                                            ///< Второе заменяемое ребро иерархии
+};
+
+/*!
+ * Результат предварительной обработки графа.
+ * Ребра иерархии нумеруются так: [0, edge_count) - ребра исходного графа,
+ * далее - сокращения в порядке их добавления.
+ */
+template <typename Weight>
+struct ContractionHierarchyData {
+    std::vector<size_t> ranks;                                ///< Ранг (порядок сжатия) каждой вершины
+    std::vector<Shortcut<Weight>> shortcuts;                  ///< Добавленные ребра-сокращения
+};
+
+template <typename Weight>
+class ContractionHierarchyRouter : public BaseRouter<Weight> {
+private:
+    using Graph = typename BaseRouter<Weight>::Graph;
+
+public:
+    using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+    using HierarchyData = ContractionHierarchyData<Weight>;
+
+    /// Строит иерархию сжатия графа
+    explicit ContractionHierarchyRouter(const Graph& graph);
+
+    /// Конструктор от заранее построенной иерархии (например, загруженной из базы)
+    ContractionHierarchyRouter(const Graph& graph, HierarchyData hierarchy);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    const Graph& GetGraph() const override;
+
+    /// Порядок вершин и ребра-сокращения иерархии
+    const HierarchyData& GetHierarchyData() const;
+
+private:
+    using QueueItem = std::pair<Weight, VertexId>;
+    using MinQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    /// Ограничение на число вершин, просматриваемых при поиске обходного пути
+    static constexpr size_t WITNESS_SETTLED_LIMIT = 100;
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::max();
+
+    /// Состояние, нужное только во время построения иерархии
+    struct ContractionState {
+        std::vector<std::vector<EdgeId>> in_edges;
+        std::vector<std::vector<EdgeId>> out_edges;
+        std::vector<bool> contracted;
+        std::vector<size_t> contracted_neighbours;
+        std::vector<Weight> witness_weights;
+        std::vector<VertexId> witness_touched;
+        std::vector<bool> witness_targets;
+        size_t witness_target_count = 0;
+    };
+
+    VertexId GetFrom(EdgeId edge_id) const;
+    VertexId GetTo(EdgeId edge_id) const;
+    Weight GetWeight(EdgeId edge_id) const;
+
+    void Contract();
+    void BuildSearchGraph();
+
+    /// Оставляет в списке только самые легкие ребра к каждой соседней вершине, не затронутой сжатием
+    void CompactEdges(const ContractionState& state, std::vector<EdgeId>& edges, bool incoming) const;
+
+    /// Сжимает вершину (или, если apply == false, только считает сокращения), возвращает их количество
+    size_t ContractVertex(ContractionState& state, VertexId vertex, bool apply);
+    int ComputePriority(ContractionState& state, VertexId vertex);
+    void FindWitnesses(ContractionState& state, VertexId source, VertexId excluded, Weight max_weight) const;
+
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+    HierarchyData hierarchy_;
+    std::vector<std::vector<EdgeId>> upward_edges_;          ///< Ребра к вершинам большего ранга (для прямого поиска)
+    std::vector<std::vector<EdgeId>> downward_edges_;        ///< Входящие ребра от вершин большего ранга (для обратного поиска)
+};
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    Contract();
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph, HierarchyData hierarchy)
+    : graph_(graph)
+    , hierarchy_(std::move(hierarchy))
+{
+    if (hierarchy_.ranks.size() != graph.GetVertexCount()) {
+        throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+    }
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+const typename ContractionHierarchyRouter<Weight>::Graph& ContractionHierarchyRouter<Weight>::GetGraph() const {
+    return graph_;
+}
+
+template <typename Weight>
+const typename ContractionHierarchyRouter<Weight>::HierarchyData&
+ContractionHierarchyRouter<Weight>::GetHierarchyData() const {
+    return hierarchy_;
+}
+
+template <typename Weight>
+VertexId ContractionHierarchyRouter<Weight>::GetFrom(EdgeId edge_id) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    return edge_id < edge_count ? graph_.GetEdgeFrom(edge_id) : hierarchy_.shortcuts[edge_id - edge_count].from;
+}
+
+template <typename Weight>
+VertexId ContractionHierarchyRouter<Weight>::GetTo(EdgeId edge_id) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    return edge_id < edge_count ? graph_.GetEdgeTo(edge_id) : hierarchy_.shortcuts[edge_id - edge_count].to;
+}
+
+template <typename Weight>
+Weight ContractionHierarchyRouter<Weight>::GetWeight(EdgeId edge_id) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    return edge_id < edge_count ? graph_.GetEdgeWeight(edge_id) : hierarchy_.shortcuts[edge_id - edge_count].weight;
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::Contract() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t edge_count = graph_.GetEdgeCount();
+
+    ContractionState state;
+    state.in_edges.resize(vertex_count);
+    state.out_edges.resize(vertex_count);
+    state.contracted.assign(vertex_count, false);
+    state.contracted_neighbours.assign(vertex_count, 0);
+    state.witness_weights.assign(vertex_count, INFINITE_WEIGHT);
+    state.witness_targets.assign(vertex_count, false);
+
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto edge = graph_.GetEdge(edge_id);
+        if (edge.from != edge.to) {
+            state.out_edges[edge.from].push_back(edge_id);
+            state.in_edges[edge.to].push_back(edge_id);
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        CompactEdges(state, state.out_edges[vertex], false);
+        CompactEdges(state, state.in_edges[vertex], true);
+    }
+
+    // очередь вершин по приоритету сжатия; приоритеты обновляются лениво при извлечении
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({ComputePriority(state, vertex), vertex});
+    }
+
+    hierarchy_.ranks.assign(vertex_count, 0);
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        const int priority = ComputePriority(state, vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+
+        ContractVertex(state, vertex, true);
+        state.contracted[vertex] = true;
+        hierarchy_.ranks[vertex] = rank++;
+
+        for (const EdgeId edge_id : state.out_edges[vertex]) {
+            const VertexId neighbour = GetTo(edge_id);
+            ++state.contracted_neighbours[neighbour];
+            CompactEdges(state, state.in_edges[neighbour], true);
+        }
+        for (const EdgeId edge_id : state.in_edges[vertex]) {
+            const VertexId neighbour = GetFrom(edge_id);
+            ++state.contracted_neighbours[neighbour];
+            CompactEdges(state, state.out_edges[neighbour], false);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::CompactEdges(const ContractionState& state, std::vector<EdgeId>& edges,
+                                                      bool incoming) const {
+    auto neighbour = [this, incoming](EdgeId edge_id) {
+        return incoming ? GetFrom(edge_id) : GetTo(edge_id);
+    };
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&state, &neighbour](EdgeId edge_id) {
+        return state.contracted[neighbour(edge_id)];
+    }), edges.end());
+    std::sort(edges.begin(), edges.end(), [this, &neighbour](EdgeId lhs, EdgeId rhs) {
+        return neighbour(lhs) < neighbour(rhs) || (neighbour(lhs) == neighbour(rhs) && GetWeight(lhs) < GetWeight(rhs));
+    });
+    edges.erase(std::unique(edges.begin(), edges.end(), [&neighbour](EdgeId lhs, EdgeId rhs) {
+        return neighbour(lhs) == neighbour(rhs);
+    }), edges.end());
+}
+
+template <typename Weight>
+int ContractionHierarchyRouter<Weight>::ComputePriority(ContractionState& state, VertexId vertex) {
+    const size_t shortcuts = ContractVertex(state, vertex, false);
+    const size_t removed_edges = state.in_edges[vertex].size() + state.out_edges[vertex].size();
+    return static_cast<int>(shortcuts) - static_cast<int>(removed_edges)
+           + static_cast<int>(state.contracted_neighbours[vertex]);
+}
+
+template <typename Weight>
+size_t ContractionHierarchyRouter<Weight>::ContractVertex(ContractionState& state, VertexId vertex, bool apply) {
+    // списки ребер уже сжаты: по одному самому легкому ребру к каждому несжатому соседу,
+    // но после добавления сокращений в них могут появиться параллельные ребра
+    CompactEdges(state, state.in_edges[vertex], true);
+    CompactEdges(state, state.out_edges[vertex], false);
+    const std::vector<EdgeId>& in_best = state.in_edges[vertex];
+    const std::vector<EdgeId>& out_best = state.out_edges[vertex];
+
+    Weight max_out_weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : out_best) {
+        max_out_weight = std::max(max_out_weight, GetWeight(edge_id));
+        state.witness_targets[GetTo(edge_id)] = true;
+    }
+    state.witness_target_count = out_best.size();
+
+    std::vector<Shortcut<Weight>> shortcuts;
+    for (const EdgeId in_edge : in_best) {
+        const VertexId source = GetFrom(in_edge);
+        const Weight in_weight = GetWeight(in_edge);
+        FindWitnesses(state, source, vertex, in_weight + max_out_weight);
+
+        for (const EdgeId out_edge : out_best) {
+            const VertexId target = GetTo(out_edge);
+            if (target == source) {
+                continue;
+            }
+            const Weight shortcut_weight = in_weight + GetWeight(out_edge);
+            if (state.witness_weights[target] <= shortcut_weight) {
+                continue;
+            }
+            shortcuts.push_back({source, target, shortcut_weight, in_edge, out_edge});
+        }
+    }
+
+    for (const VertexId touched : state.witness_touched) {
+        state.witness_weights[touched] = INFINITE_WEIGHT;
+    }
+    state.witness_touched.clear();
+    for (const EdgeId edge_id : out_best) {
+        state.witness_targets[GetTo(edge_id)] = false;
+    }
+
+    if (apply) {
+        // списки ребер соседей меняются только после перебора, так как in_best и out_best ссылаются на них
+        for (const auto& shortcut : shortcuts) {
+            const EdgeId shortcut_id = graph_.GetEdgeCount() + hierarchy_.shortcuts.size();
+            hierarchy_.shortcuts.push_back(shortcut);
+            state.out_edges[shortcut.from].push_back(shortcut_id);
+            state.in_edges[shortcut.to].push_back(shortcut_id);
+        }
+    }
+
+    return shortcuts.size();
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::FindWitnesses(ContractionState& state, VertexId source, VertexId excluded,
+                                                       Weight max_weight) const {
+    for (const VertexId touched : state.witness_touched) {
+        state.witness_weights[touched] = INFINITE_WEIGHT;
+    }
+    state.witness_touched.clear();
+
+    MinQueue queue;
+    state.witness_weights[source] = ZERO_WEIGHT;
+    state.witness_touched.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+
+    size_t settled = 0;
+    size_t settled_targets = 0;
+    while (!queue.empty() && settled < WITNESS_SETTLED_LIMIT && settled_targets < state.witness_target_count) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (state.witness_weights[vertex] < weight) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        ++settled;
+        if (state.witness_targets[vertex]) {
+            ++settled_targets;
+        }
+
+        for (const EdgeId edge_id : state.out_edges[vertex]) {
+            const VertexId target = GetTo(edge_id);
+            if (target == excluded || state.contracted[target]) {
+                continue;
+            }
+            const Weight candidate_weight = weight + GetWeight(edge_id);
+            if (candidate_weight < state.witness_weights[target]) {
+                if (state.witness_weights[target] == INFINITE_WEIGHT) {
+                    state.witness_touched.push_back(target);
+                }
+                state.witness_weights[target] = candidate_weight;
+                queue.push({candidate_weight, target});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::BuildSearchGraph() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t total_edge_count = graph_.GetEdgeCount() + hierarchy_.shortcuts.size();
+
+    upward_edges_.assign(vertex_count, {});
+    downward_edges_.assign(vertex_count, {});
+
+    for (EdgeId edge_id = 0; edge_id < total_edge_count; ++edge_id) {
+        const VertexId from = GetFrom(edge_id);
+        const VertexId to = GetTo(edge_id);
+        if (hierarchy_.ranks[from] < hierarchy_.ranks[to]) {
+            upward_edges_[from].push_back(edge_id);
+        } else if (hierarchy_.ranks[from] > hierarchy_.ranks[to]) {
+            downward_edges_[to].push_back(edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchyRouter<Weight>::RouteInfo>
+ContractionHierarchyRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ZERO_WEIGHT, {}};
+    }
+
+    // индекс 0 - прямой поиск от from, индекс 1 - обратный поиск от to
+    std::vector<std::optional<Weight>> weights[2] = {std::vector<std::optional<Weight>>(vertex_count),
+                                                     std::vector<std::optional<Weight>>(vertex_count)};
+    std::vector<std::optional<EdgeId>> prev_edges[2] = {std::vector<std::optional<EdgeId>>(vertex_count),
+                                                        std::vector<std::optional<EdgeId>>(vertex_count)};
+    const std::vector<std::vector<EdgeId>>* search_edges[2] = {&upward_edges_, &downward_edges_};
+    MinQueue queues[2];
+
+    weights[0][from] = ZERO_WEIGHT;
+    weights[1][to] = ZERO_WEIGHT;
+    queues[0].push({ZERO_WEIGHT, from});
+    queues[1].push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    for (size_t direction = 0; !queues[0].empty() || !queues[1].empty(); direction ^= 1) {
+        auto& queue = queues[direction];
+        if (queue.empty()) {
+            continue;
+        }
+        const auto [weight, vertex] = queue.top();
+        if (best_weight && !(weight < *best_weight)) {
+            // в этом направлении кратчайший путь уже не улучшить
+            queue = MinQueue{};
+            continue;
+        }
+        queue.pop();
+        if (*weights[direction][vertex] < weight) {
+            continue;
+        }
+
+        if (const auto& opposite = weights[direction ^ 1][vertex]) {
+            const Weight candidate_weight = weight + *opposite;
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = vertex;
+            }
+        }
+
+        for (const EdgeId edge_id : (*search_edges[direction])[vertex]) {
+            const VertexId next = direction == 0 ? GetTo(edge_id) : GetFrom(edge_id);
+            const Weight candidate_weight = weight + GetWeight(edge_id);
+            auto& next_weight = weights[direction][next];
+            if (!next_weight || candidate_weight < *next_weight) {
+                next_weight = candidate_weight;
+                prev_edges[direction][next] = edge_id;
+                queue.push({candidate_weight, next});
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> hierarchy_edges;
+    for (VertexId vertex = meeting_vertex; vertex != from; vertex = GetFrom(*prev_edges[0][vertex])) {
+        hierarchy_edges.push_back(*prev_edges[0][vertex]);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (VertexId vertex = meeting_vertex; vertex != to; vertex = GetTo(*prev_edges[1][vertex])) {
+        hierarchy_edges.push_back(*prev_edges[1][vertex]);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < edge_count) {
+            edges.push_back(current);
+        } else {
+            const auto& shortcut = hierarchy_.shortcuts[current - edge_count];
+            stack.push_back(shortcut.second);
+            stack.push_back(shortcut.first);
+        }
+    }
+}
+
+}  // namespace graph
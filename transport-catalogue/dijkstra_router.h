@@ -0,0 +1,167 @@
+/*!
+ * @file dijkstra_router.h
+ * @brief Заголовочный файл с поиском кратчайших путей по запросу (алгоритм Дейкстры)
+ *
+ * В отличие от graph::Router не строит таблицу путей для всех пар вершин,
+ * поэтому создается мгновенно и использует память линейную от размера графа.
+ * Каждый запрос BuildRoute выполняет поиск Дейкстры с бинарной кучей.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class DijkstraRouter : public BaseRouter<Weight> {
+private:
+    using Graph = typename BaseRouter<Weight>::Graph;
+
+public:
+    using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    /// Один поиск из from, который останавливается, когда найдены пути до всех вершин to
+    std::vector<std::optional<Weight>> BuildRouteWeights(VertexId from, const std::vector<VertexId>& to) const override;
+
+    /*!
+     * Один поиск из from, который останавливается, как только кратчайший путь длиннее max_weight
+     *
+     * @return вершины с путями не длиннее max_weight и их длины по возрастанию длины пути
+     */
+    std::vector<std::pair<VertexId, Weight>> BuildReachableWeights(VertexId from, Weight max_weight) const;
+
+    bool CanUpdateEdgeWeights() const override {
+        return true;
+    }
+
+    /// Поиск читает веса прямо из графа, обновлять нечего
+    bool UpdateEdgeWeights(const std::vector<EdgeWeightChange<Weight>>&) override {
+        return true;
+    }
+
+    const Graph& GetGraph() const override;
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+const typename DijkstraRouter<Weight>::Graph& DijkstraRouter<Weight>::GetGraph() const {
+    return graph_;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<std::optional<Weight>> weights(vertex_count);
+    std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+    SearchShortestPaths(graph_, from, weights, prev_edges, [to](VertexId vertex) {
+        return vertex == to;
+    });
+
+    if (!weights[to]) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdgeFrom(*prev_edges[vertex])) {
+        edges.push_back(*prev_edges[vertex]);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{*weights[to], std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> DijkstraRouter<Weight>::BuildRouteWeights(VertexId from,
+                                                                             const std::vector<VertexId>& to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    if (to.empty()) {
+        return {};
+    }
+
+    std::vector<bool> is_target(vertex_count, false);
+    size_t targets_left = 0;
+    for (const VertexId vertex_to : to) {
+        if (vertex_to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (!is_target[vertex_to]) {
+            is_target[vertex_to] = true;
+            ++targets_left;
+        }
+    }
+
+    std::vector<std::optional<Weight>> weights(vertex_count);
+    std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+    SearchShortestPaths(graph_, from, weights, prev_edges, [&](VertexId vertex) {
+        return is_target[vertex] && --targets_left == 0;
+    });
+
+    std::vector<std::optional<Weight>> route_weights;
+    route_weights.reserve(to.size());
+    for (const VertexId vertex_to : to) {
+        route_weights.push_back(weights[vertex_to]);
+    }
+    return route_weights;
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight>::BuildReachableWeights(VertexId from, Weight max_weight) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    std::vector<std::optional<Weight>> weights(vertex_count);
+    std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+    // вершины извлекаются по возрастанию пути, поэтому все следующие тоже не укладываются в max_weight
+    SearchShortestPaths(graph_, from, weights, prev_edges, [&](VertexId vertex) {
+        if (max_weight < *weights[vertex]) {
+            return true;
+        }
+        reachable.emplace_back(vertex, *weights[vertex]);
+        return false;
+    });
+    return reachable;
+}
+
+}  // namespace graph
@@ -9,20 +9,24 @@
 */
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <string_view>
 
 #include "geo.h"
 namespace domain {
+
+using StopId = std::uint32_t;                               ///< Плотный номер остановки (он же вершина графа маршрутов)
+using BusId = std::uint32_t;                                ///< Плотный номер маршрута
     
 /// Структура с описанием остановки
 struct Stop {
     std::string stop_name;                                  ///< Название остановки
     geo::Coordinates geo_point;                             ///< Географические координаты остановки
-    size_t stop_id;                                         ///< Порядковый номер остановки
+    StopId stop_id;                                         ///< Порядковый номер остановки
     
-    Stop(std::string p_name, double p_latitude, double p_longitude, size_t id)
+    Stop(std::string p_name, double p_latitude, double p_longitude, StopId id)
 		:stop_name(std::move(p_name))
 		,geo_point({p_latitude, p_longitude}) 
         ,stop_id(id)
@@ -36,14 +40,35 @@ struct Bus {
     std::vector<Stop*> stops;                               ///< Вектор указателей на остановки входящие в маршрут
     bool round_trip;                                        ///< Флаг является ли маршрут кольцевым
     int uni_stops;                                          ///< Колличество уникальных остановок
+    std::vector<int> timetable;                             ///< Расписание: время отправления (мин. от начала суток) с каждой остановки рейса, рейсы подряд
+    BusId bus_id;                                           ///< Порядковый номер маршрута
+    std::vector<double> distances;                          ///< Расстояние по дорогам от stops[i] до stops[i + 1] (м.)
+    std::vector<double> back_distances;                     ///< Расстояние по дорогам от stops[i + 1] до stops[i] (м.)
     
-    Bus(std::string p_bus, std::vector<domain::Stop*> p_stops, bool p_flag, int p_uni) 
+    Bus(std::string p_bus, std::vector<domain::Stop*> p_stops, bool p_flag, int p_uni, BusId id) 
         :bus(std::move(p_bus))
 		,stops(std::move(p_stops))
 		,round_trip(p_flag)
 		,uni_stops(p_uni) 
+		,bus_id(id)
 	{
     }
+    
+    /// Количество остановок одного рейса: некольцевой маршрут проходится туда и обратно
+    size_t GetTripStopCount() const {
+        return round_trip || stops.empty() ? stops.size() : stops.size() * 2 - 1;
+    }
+    
+    /// Остановка рейса с номером index (на обратном пути некольцевого маршрута - в обратном порядке)
+    Stop* GetTripStop(size_t index) const {
+        return index < stops.size() ? stops[index] : stops[stops.size() * 2 - 2 - index];
+    }
+};
+
+/// Маршруты, проходящие через каждую остановку, в виде CSR (строится один раз после загрузки каталога)
+struct StopBusIndex {
+    std::vector<std::uint32_t> offsets;                     ///< Маршруты остановки s: bus_ids[offsets[s], offsets[s + 1])
+    std::vector<BusId> bus_ids;                             ///< Номера маршрутов, для каждой остановки - по возрастанию названия
 };
 
 /// Структура со статискикой маршрута
@@ -54,10 +79,59 @@ struct BusStat {
   int unique_stop_count = 0;                                ///< Колличество уникальных остановок
 };
 
+/// Алгоритм поиска кратчайших маршрутов
+enum class RouterType {
+  FLOYD_WARSHALL,                                           ///< Таблица путей для всех пар остановок, строится заранее
+  DIJKSTRA,                                                 ///< Поиск Дейкстры на каждый запрос, без предварительных вычислений
+  CONTRACTION_HIERARCHY,                                    ///< Двунаправленный поиск по иерархии сжатия графа, строится заранее
+  BLOCKED_FLOYD_WARSHALL,                                   ///< Таблица путей для всех пар остановок, блочный параллельный алгоритм
+  A_STAR,                                                   ///< Поиск A* на каждый запрос с оценкой по расстоянию по прямой
+  ALT,                                                      ///< Поиск A* с оценкой по ориентирам, веса путей до ориентиров строятся заранее
+  RAPTOR,                                                   ///< Поиск раундами по последовательностям остановок маршрутов, граф не строится
+};
+
+/// Способ построения графа маршрутов
+enum class GraphModel {
+  STOP_PAIRS,                                               ///< Ребро для каждой пары остановок маршрута (O(k^2) ребер на маршрут)
+  RIDE_VERTICES,                                            ///< Вершины "в автобусе" с ребрами посадки, проезда и высадки (O(k) ребер на маршрут)
+};
+
+/// Точность хранения весов в плоской таблице путей BLOCKED_FLOYD_WARSHALL
+enum class RouteTablePrecision {
+  DOUBLE,                                                   ///< 12 байт на пару остановок
+  FLOAT,                                                    ///< 8 байт на пару остановок, вес маршрута пересчитывается по ребрам
+};
+
+/// Данные для нижней оценки времени в пути по расстоянию по прямой (эвристика A_STAR)
+struct GeoBound {
+  std::vector<geo::Coordinates> vertex_points;              ///< Координаты остановки каждой вершины графа маршрутов
+  double min_time_per_meter = 0;                            ///< Наименьшее время проезда метра по прямой среди всех перегонов (мин.)
+  size_t stop_vertex_count = 0;                             ///< Вершины-остановки идут первыми, из них до другой вершины не доехать без ожидания
+  double wait_time = 0;                                     ///< Время ожидания автобуса (мин.)
+};
+
+/// Критерий выбора маршрута для RAPTOR
+enum class RouteCriterion {
+  MIN_TIME,                                                 ///< Наименьшее время в пути
+  MIN_TRANSFERS,                                            ///< Наименьшее число пересадок, из таких - наименьшее время
+};
+
+/// Последовательность остановок, проезжаемых автобусом в одном направлении (для RAPTOR)
+struct RoutePattern {
+  const Bus* bus;                                           ///< Маршрут
+  std::vector<size_t> stops;                                ///< Номера остановок в порядке проезда
+  std::vector<double> distances;                            ///< Расстояние по дорогам от первой остановки до каждой (м.)
+};
+
 /// Структура с настройками для поиска кратчайших маршрутов
 struct RoutingSetting {
   int wait_time = 0;                                        ///< Время ожидания автобуса на остановке (мин.)
   int bus_velocity = 0;                                     ///< Средняя скорость автобуса между остановками (км./ч.)
+  RouterType router_type = RouterType::FLOYD_WARSHALL;      ///< Алгоритм поиска кратчайших маршрутов
+  GraphModel graph_model = GraphModel::STOP_PAIRS;          ///< Способ построения графа маршрутов
+  RouteTablePrecision route_table_precision = RouteTablePrecision::DOUBLE;  ///< Точность весов в плоской таблице путей
+  int landmark_count = 8;                                   ///< Количество ориентиров для ALT
+  RouteCriterion route_criterion = RouteCriterion::MIN_TIME;  ///< Критерий выбора маршрута для RAPTOR
 };
 
 /// Структура с информацией о маршруте
@@ -0,0 +1,164 @@
+#include "flat_base.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace flat_base;
+
+namespace {
+
+constexpr char MAGIC[8] = {'T', 'C', 'F', 'L', 'A', 'T', '\0', '\0'};
+constexpr size_t ALIGNMENT = 8;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t section_count;
+    std::uint64_t checksum;             ///< FNV-1a всех байтов после заголовка
+    std::uint64_t file_size;
+};
+
+static_assert(sizeof(Header) % ALIGNMENT == 0 && sizeof(SectionEntry) % ALIGNMENT == 0,
+              "Header and section table should keep sections aligned");
+static_assert(sizeof(StopRecord) == 24 && sizeof(DistanceRecord) == 16 && sizeof(BusRecord) == 32 && sizeof(EdgeRecord) == 24,
+              "Record layout is a part of the file format");
+
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+/// Продолжает контрольную сумму FNV-1a байтами data
+std::uint64_t UpdateChecksum(std::uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+size_t GetPadding(size_t size) {
+    return (ALIGNMENT - size % ALIGNMENT) % ALIGNMENT;
+}
+
+}  // namespace
+
+bool flat_base::IsFlatBase(const std::string& file) {
+    std::ifstream in(file, std::ios::binary);
+    char magic[sizeof(MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void Writer::AddSection(SectionId id, std::uint32_t element_size, const void* data, size_t size) {
+    sections_.push_back({id, element_size, static_cast<const char*>(data), size});
+}
+
+void Writer::Save(const std::string& file) const {
+    // секции идут за таблицей в порядке добавления, каждая - с выравниванием
+    std::vector<SectionEntry> table;
+    table.reserve(sections_.size());
+    std::uint64_t offset = sizeof(Header) + sections_.size() * sizeof(SectionEntry);
+    for (const auto& section : sections_) {
+        table.push_back({static_cast<std::uint32_t>(section.id), section.element_size, offset, section.size});
+        offset += section.size + GetPadding(section.size);
+    }
+
+    const char padding[ALIGNMENT] = {};
+    std::uint64_t checksum = UpdateChecksum(FNV_OFFSET_BASIS, reinterpret_cast<const char*>(table.data()),
+                                            table.size() * sizeof(SectionEntry));
+    for (const auto& section : sections_) {
+        checksum = UpdateChecksum(checksum, section.data, section.size);
+        checksum = UpdateChecksum(checksum, padding, GetPadding(section.size));
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.section_count = static_cast<std::uint32_t>(sections_.size());
+    header.checksum = checksum;
+    header.file_size = offset;
+
+    std::ofstream out(file, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SectionEntry));
+    for (const auto& section : sections_) {
+        out.write(section.data, section.size);
+        out.write(padding, GetPadding(section.size));
+    }
+    if (!out) {
+        throw std::runtime_error("Can't write flat base " + file);
+    }
+}
+
+MappedBase::MappedBase(const std::string& file) {
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open flat base " + file);
+    }
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("Flat base " + file + " is truncated");
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // отображение остается действительным и после закрытия файла
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Can't map flat base " + file);
+    }
+    data_ = static_cast<const char*>(mapped);
+
+    try {
+        Header header;
+        std::memcpy(&header, data_, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("File " + file + " is not a flat base");
+        }
+        if (header.version != VERSION) {
+            throw std::runtime_error("Flat base " + file + " has unsupported version " + std::to_string(header.version));
+        }
+        if (header.file_size != size_
+            || header.section_count > (size_ - sizeof(Header)) / sizeof(SectionEntry)) {
+            throw std::runtime_error("Flat base " + file + " is truncated");
+        }
+        if (UpdateChecksum(FNV_OFFSET_BASIS, data_ + sizeof(Header), size_ - sizeof(Header)) != header.checksum) {
+            throw std::runtime_error("Flat base " + file + " is corrupted (checksum mismatch)");
+        }
+
+        sections_ = reinterpret_cast<const SectionEntry*>(data_ + sizeof(Header));
+        section_count_ = header.section_count;
+        for (size_t i = 0; i < section_count_; ++i) {
+            const SectionEntry& entry = sections_[i];
+            if (entry.offset % ALIGNMENT != 0 || entry.offset > size_ || entry.size > size_ - entry.offset) {
+                throw std::runtime_error("Flat base " + file + " has a section out of the file");
+            }
+        }
+        strings_ = GetSection<char>(SectionId::STRINGS);
+    } catch (...) {
+        munmap(const_cast<char*>(data_), size_);
+        throw;
+    }
+}
+
+MappedBase::~MappedBase() {
+    munmap(const_cast<char*>(data_), size_);
+}
+
+const SectionEntry* MappedBase::FindSection(SectionId id) const {
+    const SectionEntry* end = sections_ + section_count_;
+    const SectionEntry* entry = std::find_if(sections_, end, [id](const SectionEntry& entry) {
+        return entry.id == static_cast<std::uint32_t>(id);
+    });
+    return entry == end ? nullptr : entry;
+}
+
+std::string_view MappedBase::GetString(std::uint32_t offset, std::uint32_t size) const {
+    const Span<char> name = strings_.Sub(offset, size);
+    return {name.data, name.size};
+}
@@ -0,0 +1,192 @@
+/*!
+ * @file flat_base.h
+ * @brief Заголовочный файл с плоским двоичным форматом базы каталога
+ *
+ * Файл состоит из заголовка, таблицы секций и самих секций. Секция - непрерывный массив
+ * записей фиксированного размера (или байтов), начало каждой секции выровнено на 8 байт,
+ * поэтому после отображения файла в память (mmap) записи читаются на месте, без разбора.
+ * Заголовок хранит версию формата и контрольную сумму всего, что идет после него.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace flat_base {
+
+/// Версия формата: записи другой версии не читаются
+inline constexpr std::uint32_t VERSION = 1;
+
+/// Секции базы
+enum class SectionId : std::uint32_t {
+    STRINGS = 1,            ///< Названия остановок и маршрутов подряд (байты)
+    STOPS,                  ///< StopRecord по номерам остановок
+    DISTANCES,              ///< DistanceRecord по возрастанию номеров остановок
+    BUSES,                  ///< BusRecord по номерам маршрутов
+    BUS_STOPS,              ///< Номера остановок всех маршрутов подряд (uint32)
+    TIMETABLES,             ///< Расписания всех маршрутов подряд (int32, мин. от начала суток)
+    STOP_BUS_OFFSETS,       ///< domain::StopBusIndex::offsets
+    STOP_BUS_IDS,           ///< domain::StopBusIndex::bus_ids
+    EDGES,                  ///< EdgeRecord по номерам ребер графа маршрутов
+    INCIDENCE_OFFSETS,      ///< Ребра, выходящие из вершины v: INCIDENCE_EDGES[offsets[v], offsets[v + 1]) (uint32)
+    INCIDENCE_EDGES,        ///< Номера ребер (uint32)
+    PROTO,                  ///< Остальные данные каталога - сообщение catalog_buf::Catalog (байты)
+    ROUTE_WEIGHTS,          ///< Таблица путей движка: веса путей from * vertex_count + to (double, бесконечность - пути нет)
+    ROUTE_COMPACT_WEIGHTS,  ///< То же во float (RouteTablePrecision::FLOAT)
+    ROUTE_PREV_EDGES,       ///< Последние ребра путей таблицы (uint32, NO_EDGE - пути нет или from == to)
+};
+
+struct StopRecord {
+    double lat;
+    double lng;
+    std::uint32_t name_offset;          ///< Начало названия в STRINGS
+    std::uint32_t name_size;
+};
+
+struct DistanceRecord {
+    std::uint32_t from;
+    std::uint32_t to;
+    double distance;
+};
+
+struct BusRecord {
+    std::uint32_t name_offset;          ///< Начало названия в STRINGS
+    std::uint32_t name_size;
+    std::uint32_t stops_begin;          ///< Остановки маршрута: BUS_STOPS[stops_begin, stops_begin + stop_count)
+    std::uint32_t stop_count;
+    std::uint32_t timetable_begin;      ///< Расписание маршрута: TIMETABLES[timetable_begin, timetable_begin + timetable_size)
+    std::uint32_t timetable_size;
+    std::uint32_t round_trip;
+    std::uint32_t reserved;
+};
+
+struct EdgeRecord {
+    std::uint32_t from;
+    std::uint32_t to;
+    double weight;
+    std::uint32_t stops_count;
+    std::uint32_t bus_id;               ///< Номер маршрута, NO_BUS - ребро высадки
+
+    static constexpr std::uint32_t NO_BUS = 0xFFFFFFFFu;
+};
+
+/// Запись таблицы секций
+struct SectionEntry {
+    std::uint32_t id;
+    std::uint32_t element_size;         ///< Размер записи (1 - байты)
+    std::uint64_t offset;               ///< От начала файла, кратно 8
+    std::uint64_t size;                 ///< В байтах
+};
+
+/// Массив записей секции, лежащий в отображенном файле
+template <typename T>
+struct Span {
+    const T* data = nullptr;
+    size_t size = 0;
+
+    const T* begin() const {
+        return data;
+    }
+    const T* end() const {
+        return data + size;
+    }
+    const T& operator[](size_t i) const {
+        return data[i];
+    }
+    /// Записи [begin, begin + count), std::out_of_range - выход за границы секции
+    Span<T> Sub(size_t begin, size_t count) const {
+        if (begin > size || count > size - begin) {
+            throw std::out_of_range("Flat base record range is out of its section");
+        }
+        return {data + begin, count};
+    }
+};
+
+/// Проверяет по сигнатуре в начале файла, что база записана в плоском формате
+bool IsFlatBase(const std::string& file);
+
+/*!
+ * Записывает базу в плоском формате
+ *
+ * Секции не копируются: данные, переданные в AddSection, должны жить до вызова Save
+ */
+class Writer {
+public:
+    template <typename T>
+    void AddSection(SectionId id, const std::vector<T>& items) {
+        static_assert(std::is_trivially_copyable_v<T>, "Section records should be trivially copyable");
+        AddSection(id, sizeof(T), items.data(), items.size() * sizeof(T));
+    }
+
+    void AddSection(SectionId id, std::uint32_t element_size, const void* data, size_t size);
+
+    /// std::runtime_error - файл не удалось записать
+    void Save(const std::string& file) const;
+
+private:
+    struct Section {
+        SectionId id;
+        std::uint32_t element_size;
+        const char* data;
+        size_t size;
+    };
+
+    std::vector<Section> sections_;
+};
+
+/*!
+ * База в плоском формате, отображенная в память только для чтения
+ *
+ * При открытии проверяются сигнатура, версия, размер файла, контрольная сумма и границы секций
+ * (std::runtime_error - база повреждена или другой версии)
+ */
+class MappedBase {
+public:
+    explicit MappedBase(const std::string& file);
+    ~MappedBase();
+
+    MappedBase(const MappedBase&) = delete;
+    MappedBase& operator=(const MappedBase&) = delete;
+
+    /// Записи секции (пусто, если секции нет), std::runtime_error - размер записей не совпадает с T
+    template <typename T>
+    Span<T> GetSection(SectionId id) const {
+        static_assert(std::is_trivially_copyable_v<T>, "Section records should be trivially copyable");
+        const SectionEntry* entry = FindSection(id);
+        if (entry == nullptr) {
+            return {};
+        }
+        if (entry->element_size != sizeof(T) || entry->size % sizeof(T) != 0 || entry->offset % alignof(T) != 0) {
+            throw std::runtime_error("Flat base section has unexpected record size");
+        }
+        return {reinterpret_cast<const T*>(data_ + entry->offset), static_cast<size_t>(entry->size / sizeof(T))};
+    }
+
+    bool HasSection(SectionId id) const {
+        return FindSection(id) != nullptr;
+    }
+
+    /// Название из секции STRINGS, std::out_of_range - выход за границы секции
+    std::string_view GetString(std::uint32_t offset, std::uint32_t size) const;
+
+private:
+    const SectionEntry* FindSection(SectionId id) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    const SectionEntry* sections_ = nullptr;
+    size_t section_count_ = 0;
+    Span<char> strings_;
+};
+
+}  // namespace flat_base
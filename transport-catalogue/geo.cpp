@@ -17,4 +17,14 @@ double ComputeDistance(Coordinates from, Coordinates to) {
         * earth_radius;
 }
 
+double ComputeHaversineDistance(Coordinates from, Coordinates to) {
+    using namespace std;
+    const double earth_radius = 6371000;
+    static const double dr = M_PI / 180.;
+    const double sin_lat = sin((to.lat - from.lat) * dr / 2);
+    const double sin_lng = sin((to.lng - from.lng) * dr / 2);
+    const double h = sin_lat * sin_lat + cos(from.lat * dr) * cos(to.lat * dr) * sin_lng * sin_lng;
+    return 2 * asin(min(1.0, sqrt(h))) * earth_radius;
+}
+
 }  // namespace geo
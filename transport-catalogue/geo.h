@@ -37,4 +37,15 @@ struct Coordinates {
  */
 double ComputeDistance(Coordinates from, Coordinates to);
 
+/*!
+ * Функция вычисления растояния между координатами по формуле гаверсинусов
+ * 
+ * В отличие от ComputeDistance не теряет точность на малых расстояниях,
+ * поэтому подходит для нижних оценок, где важно соблюдать неравенство треугольника
+ * 
+ * @param from Координаты откуда
+ * @param to Координаты куда
+ */
+double ComputeHaversineDistance(Coordinates from, Coordinates to);
+
 }  // namespace geo
@@ -13,7 +13,10 @@
 #include "ranges.h"
 #include "domain.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -31,16 +34,32 @@ struct Edge {
     domain::Bus* bus;                                         ///< Указатель на маршрут которому соответствует данное ребро
 };
 
+/// Изменение веса ребра: номер ребра и его вес до изменения
+template <typename Weight>
+struct EdgeWeightChange {
+    EdgeId edge_id;
+    Weight old_weight;
+};
+
 /*!
  * Класс реализующий направленный взвешенный граф
+ * 
+ * После заполнения граф можно "заморозить" (Freeze): списки инцидентности отдельных вершин
+ * заменяются компактным представлением CSR - массивом смещений и общими массивами
+ * номеров ребер, вершин назначения и весов, упорядоченными по исходящей вершине.
+ * Вершина назначения и вес ребра хранятся только в дуге, для вывода маршрута по номеру ребра
+ * остаются его начало, маршрут и количество остановок; ребро собирается из этих массивов.
  */
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>; ///< Список номеров всех ребер
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using CompactId = std::uint32_t;           ///< Номер вершины, ребра или дуги в массивах графа
+    using IncidenceList = std::vector<CompactId>; ///< Список номеров всех ребер
 
 public:
+    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    
+
 	/// Конструктор по умолчанию
     DirectedWeightedGraph() = default;
 	
@@ -48,7 +67,7 @@ public:
     explicit DirectedWeightedGraph(size_t vertex_count);
 	
 	/// Конструктор от параметров
-	DirectedWeightedGraph(std::vector<IncidenceList> incidence_lists, std::vector<Edge<Weight>> edges);
+	DirectedWeightedGraph(std::vector<std::vector<EdgeId>> incidence_lists, std::vector<Edge<Weight>> edges);
     
 	/// Добавление ребра в граф, возвращает номер ребра
 	EdgeId AddEdge(const Edge<Weight>& edge);
@@ -59,15 +78,48 @@ public:
 	/// Получить количество ребер в графе
     size_t GetEdgeCount() const;
 	
-	/// Получить ребро графа по номеру ребра
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+	/// Получить ребро графа по номеру ребра (в замороженном графе ребро собирается по частям)
+    Edge<Weight> GetEdge(EdgeId edge_id) const;
+	
+	/// Начало, конец и вес ребра по номеру без сборки всего ребра (номер не проверяется)
+	VertexId GetEdgeFrom(EdgeId edge_id) const;
+	VertexId GetEdgeTo(EdgeId edge_id) const;
+	Weight GetEdgeWeight(EdgeId edge_id) const;
+	
+	/// Изменить вес ребра (в том числе в замороженном графе)
+	void SetEdgeWeight(EdgeId edge_id, Weight weight);
 	
 	/// Получить номера ребер выходящих из вершины vertex
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+	
+	/// Перевести граф в компактное неизменяемое представление CSR
+	void Freeze();
+	
+	/// Заморожен ли граф
+	bool IsFrozen() const;
+	
+	/// Позиции [begin, end) исходящих из вершины дуг в массивах CSR (только для замороженного графа)
+	size_t GetArcBegin(VertexId vertex) const;
+	size_t GetArcEnd(VertexId vertex) const;
+	
+	/// Номер ребра, вершина назначения и вес дуги по ее позиции в CSR (только для замороженного графа)
+	EdgeId GetArcEdge(size_t arc) const;
+	VertexId GetArcTarget(size_t arc) const;
+	Weight GetArcWeight(size_t arc) const;
 
 private:
-	std::vector<Edge<Weight>> edges_;   ///< Вектор ребер графа
-    std::vector<IncidenceList> incidence_lists_; ///< Вектор векторов номеров графа от исходящей вершины
+	std::vector<Edge<Weight>> edges_;   ///< Вектор ребер графа (до заморозки)
+    std::vector<IncidenceList> incidence_lists_; ///< Вектор векторов номеров графа от исходящей вершины (до заморозки)
+	
+	bool frozen_ = false;                ///< Флаг заморозки графа
+	std::vector<size_t> arc_offsets_;    ///< Смещения дуг каждой вершины, размер - количество вершин + 1
+	IncidenceList arc_edges_;            ///< Номера ребер, упорядоченные по исходящей вершине
+	std::vector<CompactId> arc_targets_; ///< Вершины назначения дуг
+	std::vector<Weight> arc_weights_;    ///< Веса дуг
+	std::vector<CompactId> edge_arcs_;   ///< Дуга каждого ребра
+	std::vector<CompactId> edge_froms_;  ///< Вершина начала каждого ребра
+	std::vector<int> edge_stops_counts_; ///< Количество остановок каждого ребра
+	std::vector<domain::Bus*> edge_buses_; ///< Маршрут каждого ребра
 };
 
 template <typename Weight>
@@ -76,37 +128,156 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
 }
 
 template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<IncidenceList> incidence_lists, std::vector<Edge<Weight>> edges)
-	: edges_(edges)
-	, incidence_lists_(incidence_lists) {
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<std::vector<EdgeId>> incidence_lists, std::vector<Edge<Weight>> edges)
+	: edges_(std::move(edges))
+	, incidence_lists_(incidence_lists.size()) {
+    if (edges_.size() > std::numeric_limits<CompactId>::max()) {
+        throw std::length_error("Too many edges in the graph");
+    }
+    for (size_t vertex = 0; vertex < incidence_lists.size(); ++vertex) {
+        incidence_lists_[vertex].assign(incidence_lists[vertex].begin(), incidence_lists[vertex].end());
+        std::vector<EdgeId>().swap(incidence_lists[vertex]);
+    }
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (frozen_) {
+        throw std::logic_error("Can't add an edge to a frozen graph");
+    }
+    if (edges_.size() == std::numeric_limits<CompactId>::max()) {
+        throw std::length_error("Too many edges in the graph");
+    }
+    incidence_lists_.at(edge.from).push_back(static_cast<CompactId>(edges_.size()));
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+    return edges_.size() - 1;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return frozen_ ? arc_offsets_.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-    return edges_.size();
+    return frozen_ ? edge_arcs_.size() : edges_.size();
 }
 
 template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    if (frozen_) {
+        const CompactId arc = edge_arcs_.at(edge_id);
+        return {edge_froms_[edge_id], arc_targets_[arc], arc_weights_[arc], edge_stops_counts_[edge_id], edge_buses_[edge_id]};
+    }
     return edges_.at(edge_id);
 }
 
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeFrom(EdgeId edge_id) const {
+    return frozen_ ? edge_froms_[edge_id] : edges_[edge_id].from;
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeTo(EdgeId edge_id) const {
+    return frozen_ ? arc_targets_[edge_arcs_[edge_id]] : edges_[edge_id].to;
+}
+
+template <typename Weight>
+Weight DirectedWeightedGraph<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+    return frozen_ ? arc_weights_[edge_arcs_[edge_id]] : edges_[edge_id].weight;
+}
+
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    if (frozen_) {
+        return IncidentEdgesRange(arc_edges_.begin() + GetArcBegin(vertex), arc_edges_.begin() + GetArcEnd(vertex));
+    }
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (frozen_) {
+        return;
+    }
+    
+    const size_t vertex_count = incidence_lists_.size();
+    const size_t edge_count = edges_.size();
+    if (vertex_count > std::numeric_limits<CompactId>::max()) {
+        throw std::length_error("Too many vertices to freeze the graph");
+    }
+    arc_offsets_.assign(vertex_count + 1, 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        arc_offsets_[vertex + 1] = arc_offsets_[vertex] + incidence_lists_[vertex].size();
+    }
+    
+    const size_t arc_count = arc_offsets_.back();
+    arc_edges_.reserve(arc_count);
+    arc_targets_.reserve(arc_count);
+    arc_weights_.reserve(arc_count);
+    edge_arcs_.resize(edge_count);
+    for (const auto& incidence_list : incidence_lists_) {
+        for (const EdgeId edge_id : incidence_list) {
+            const auto& edge = edges_.at(edge_id);
+            edge_arcs_[edge_id] = static_cast<CompactId>(arc_edges_.size());
+            arc_edges_.push_back(edge_id);
+            arc_targets_.push_back(static_cast<CompactId>(edge.to));
+            arc_weights_.push_back(edge.weight);
+        }
+    }
+    
+    edge_froms_.reserve(edge_count);
+    edge_stops_counts_.reserve(edge_count);
+    edge_buses_.reserve(edge_count);
+    for (const auto& edge : edges_) {
+        edge_froms_.push_back(static_cast<CompactId>(edge.from));
+        edge_stops_counts_.push_back(edge.stops_count);
+        edge_buses_.push_back(edge.bus);
+    }
+    
+    // освобождаем память ребер и списков инцидентности: их данные теперь в массивах дуг и ребер
+    std::vector<Edge<Weight>>().swap(edges_);
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    frozen_ = true;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    if (frozen_) {
+        arc_weights_[edge_arcs_.at(edge_id)] = weight;
+    } else {
+        edges_.at(edge_id).weight = weight;
+    }
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return frozen_;
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetArcBegin(VertexId vertex) const {
+    return arc_offsets_.at(vertex);
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetArcEnd(VertexId vertex) const {
+    return arc_offsets_.at(vertex + 1);
+}
+
+template <typename Weight>
+EdgeId DirectedWeightedGraph<Weight>::GetArcEdge(size_t arc) const {
+    return arc_edges_[arc];
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetArcTarget(size_t arc) const {
+    return arc_targets_[arc];
+}
+
+template <typename Weight>
+Weight DirectedWeightedGraph<Weight>::GetArcWeight(size_t arc) const {
+    return arc_weights_[arc];
+}
 }  // namespace graph
@@ -38,6 +38,17 @@ void AddBusInCatalog(catalog::TransportCatalogue& catalog, const json::Dict& map
     bool round = map_with_bus.at("is_roundtrip").AsBool();
     
     catalog.AddBus(bus_name, stops, round);  
+    
+    // расписание - массив рейсов, у каждого рейса время отправления с каждой его остановки
+    if (map_with_bus.count("timetable")) {
+        std::vector<int> timetable;
+        for (auto& trip : map_with_bus.at("timetable").AsArray()) {
+            for (auto& departure : trip.AsArray()) {
+                timetable.push_back(departure.AsInt());
+            }
+        }
+        catalog.SetBusTimetable(bus_name, std::move(timetable));
+    }
 }
 
 
@@ -57,13 +68,69 @@ void CompleteCatalog(catalog::TransportCatalogue& catalog, const json::Node& bas
 			AddBusInCatalog(catalog, input_modul.AsDict());
 		}
 	}
+	catalog.BuildStopBusIndex();
+	catalog.BuildBusStats();
 }
 
 void AddRoutingSettingInCatalog(catalog::TransportCatalogue& catalog, const json::Node& map_with_setting) {
-    int wait_time =  map_with_setting.AsDict().at("bus_wait_time").AsInt();
-    int bus_velocity =  map_with_setting.AsDict().at("bus_velocity").AsInt();
+    domain::RoutingSetting routing_setting;
+    routing_setting.wait_time =  map_with_setting.AsDict().at("bus_wait_time").AsInt();
+    routing_setting.bus_velocity =  map_with_setting.AsDict().at("bus_velocity").AsInt();
+    
+    if (map_with_setting.AsDict().count("router_type")) {
+        const std::string& type_name = map_with_setting.AsDict().at("router_type").AsString();
+        if (type_name == "dijkstra") {
+            routing_setting.router_type = domain::RouterType::DIJKSTRA;
+        } else if (type_name == "contraction_hierarchy") {
+            routing_setting.router_type = domain::RouterType::CONTRACTION_HIERARCHY;
+        } else if (type_name == "blocked_floyd_warshall") {
+            routing_setting.router_type = domain::RouterType::BLOCKED_FLOYD_WARSHALL;
+        } else if (type_name == "a_star") {
+            routing_setting.router_type = domain::RouterType::A_STAR;
+        } else if (type_name == "alt") {
+            routing_setting.router_type = domain::RouterType::ALT;
+        } else if (type_name == "raptor") {
+            routing_setting.router_type = domain::RouterType::RAPTOR;
+        } else if (type_name != "floyd_warshall") {
+            throw std::invalid_argument("Unknown router_type: "s + type_name);
+        }
+    }
+    
+    if (map_with_setting.AsDict().count("graph_model")) {
+        const std::string& model_name = map_with_setting.AsDict().at("graph_model").AsString();
+        if (model_name == "ride_vertices") {
+            routing_setting.graph_model = domain::GraphModel::RIDE_VERTICES;
+        } else if (model_name != "stop_pairs") {
+            throw std::invalid_argument("Unknown graph_model: "s + model_name);
+        }
+    }
     
-    catalog.AddRoutingSetting(wait_time, bus_velocity); 
+    if (map_with_setting.AsDict().count("route_table_precision")) {
+        const std::string& precision_name = map_with_setting.AsDict().at("route_table_precision").AsString();
+        if (precision_name == "float") {
+            routing_setting.route_table_precision = domain::RouteTablePrecision::FLOAT;
+        } else if (precision_name != "double") {
+            throw std::invalid_argument("Unknown route_table_precision: "s + precision_name);
+        }
+    }
+    
+    if (map_with_setting.AsDict().count("landmark_count")) {
+        routing_setting.landmark_count = map_with_setting.AsDict().at("landmark_count").AsInt();
+        if (routing_setting.landmark_count < 0) {
+            throw std::invalid_argument("landmark_count should be non-negative");
+        }
+    }
+    
+    if (map_with_setting.AsDict().count("route_criterion")) {
+        const std::string& criterion_name = map_with_setting.AsDict().at("route_criterion").AsString();
+        if (criterion_name == "min_transfers") {
+            routing_setting.route_criterion = domain::RouteCriterion::MIN_TRANSFERS;
+        } else if (criterion_name != "min_time") {
+            throw std::invalid_argument("Unknown route_criterion: "s + criterion_name);
+        }
+    }
+    
+    catalog.AddRoutingSetting(routing_setting); 
 }
 
 void BuildRouter(catalog::TransportCatalogue& catalog) {
@@ -88,6 +155,7 @@ std::variant<std::monostate, std::string, svg::Rgb, svg::Rgba> GetColor(const js
 void BuildGraph(catalog::TransportCatalogue& catalog) {
     catalog.InitRouterGraph();
     catalog.AddEdgeInRouterGraph();
+    catalog.FreezeRouterGraph();
 }
 
 void SetRenderSetting(map_renderer::MapRanderer& map, const json::Node& render_settings) {
@@ -141,6 +209,17 @@ void SetRenderSetting(map_renderer::MapRanderer& map, const json::Node& render_s
     
 void SetSerializationFile(serialization::Serialization& serialization, const json::Node& serialization_file) {
     serialization.SetFilePath(serialization_file.AsDict().at("file").AsString());
+    
+    if (serialization_file.AsDict().count("format")) {
+        const std::string& format = serialization_file.AsDict().at("format").AsString();
+        if (format == "protobuf") {
+            serialization.SetFormat(serialization::BaseFormat::PROTOBUF);
+        } else if (format == "flat") {
+            serialization.SetFormat(serialization::BaseFormat::FLAT);
+        } else {
+            throw std::invalid_argument("Unknown base format " + format);
+        }
+    }
 }
 
 json::Dict MakeBusDict(const RequestHandler& handler, const json::Node& requests) {
@@ -217,9 +296,43 @@ json::Dict MakeMapDict(const RequestHandler& handler, const json::Node& requests
 				.AsDict();
 }
 
+json::Array MakeRouteItems(const std::vector<domain::RouteInfo>& route_info) {
+    json::Array route;
+    for (auto info : route_info) {
+        json::Dict wait = json::Builder{}
+                            .StartDict()
+                                .Key("stop_name"s).Value(std::string(info.wait_stop))
+                                .Key("time"s).Value(info.wait_time)
+                                .Key("type"s).Value("Wait")
+                            .EndDict()
+                        .Build()
+                        .AsDict();
+        route.push_back(wait);
+        
+        json::Dict bus = json::Builder{}
+                            .StartDict()
+                                .Key("bus"s).Value(std::string(info.bus_name))
+                                .Key("span_count"s).Value(info.span_count)
+                                .Key("time"s).Value(info.time)
+                                .Key("type"s).Value("Bus")
+                            .EndDict()
+                        .Build()
+                        .AsDict();
+        route.push_back(bus);
+    }
+    return route;
+}
+
 json::Dict MakeRouteDict(const RequestHandler& handler, const json::Node& requests) {
-    auto anser = handler.GetRouter(requests.AsDict().at("from").AsString(), requests.AsDict().at("to").AsString());
-    
+    const json::Dict& request = requests.AsDict();
+    // с временем отправления путь ищется по расписанию маршрутов
+    auto anser = request.count("departure_time") 
+                    ? handler.GetRouter(request.at("from").AsString(), request.at("to").AsString(), request.at("departure_time").AsInt())
+                    : handler.GetRouter(request.at("from").AsString(), request.at("to").AsString());
+    return MakeRouteAnswerDict(requests, anser);
+}
+
+json::Dict MakeRouteAnswerDict(const json::Node& requests, const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>>& anser) {
     if ( !anser ) {
 		return json::Builder{}
 					.StartDict()
@@ -229,44 +342,223 @@ json::Dict MakeRouteDict(const RequestHandler& handler, const json::Node& reques
 				.Build()
 				.AsDict();
 	} else {
-        json::Array route;
-        for (auto info : std::get<1>(anser.value())) {
-            json::Dict wait = json::Builder{}
-                                .StartDict()
-                                    .Key("stop_name"s).Value(std::string(info.wait_stop))
-                                    .Key("time"s).Value(info.wait_time)
-                                    .Key("type"s).Value("Wait")
-                                .EndDict()
-                            .Build()
-                            .AsDict();
-            route.push_back(wait);
-            
-            json::Dict bus = json::Builder{}
-                                .StartDict()
-                                    .Key("bus"s).Value(std::string(info.bus_name))
-                                    .Key("span_count"s).Value(info.span_count)
-                                    .Key("time"s).Value(info.time)
-                                    .Key("type"s).Value("Bus")
-                                .EndDict()
-                            .Build()
-                            .AsDict();
-            route.push_back(bus);
-        }
         return json::Builder{}
 					.StartDict()
                         .Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
                         .Key("total_time"s).Value(std::get<0>(anser.value()))
-                        .Key("items"s).Value(route)
+                        .Key("items"s).Value(MakeRouteItems(std::get<1>(anser.value())))
                     .EndDict()
                 .Build()
                 .AsDict();
     }
 }
 
-void GetStatistic(RequestHandler& handler, const json::Node& stat_requests, std::ostream& out) {
+json::Dict MakeRouteDict(const RequestHandler& handler, const json::Node& requests, RouteCache& route_cache) {
+    // ответ по расписанию зависит от времени отправления и не кэшируется
+    if (requests.AsDict().count("departure_time")) {
+        return MakeRouteDict(handler, requests);
+    }
+    
+    // номера остановок находятся один раз: и для ключа кэша, и для поиска пути при промахе
+    const auto from = handler.FindStopId(requests.AsDict().at("from").AsString());
+    const auto to = handler.FindStopId(requests.AsDict().at("to").AsString());
+    if (!from || !to) {
+        return MakeRouteAnswerDict(requests, std::nullopt);
+    }
+    const std::uint64_t key = MakeRouteCacheKey(*from, *to);
+    
+    if (const json::Dict* cached = route_cache.Find(key)) {
+        json::Dict anser = *cached;
+        anser["request_id"s] = requests.AsDict().at("id").AsInt();
+        return anser;
+    }
+    
+    json::Dict anser = MakeRouteAnswerDict(requests, handler.GetRouter(*from, *to));
+    json::Dict cached = anser;
+    cached.erase("request_id"s);
+    route_cache.Insert(key, std::move(cached));
+    return anser;
+}
+
+json::Dict MakeRouteCacheStatDict(const RouteCache& route_cache, const json::Node& requests) {
+    return json::Builder{}
+                .StartDict()
+                    .Key("capacity"s).Value(static_cast<int>(route_cache.GetCapacity()))
+                    .Key("hits"s).Value(static_cast<int>(route_cache.GetHits()))
+                    .Key("misses"s).Value(static_cast<int>(route_cache.GetMisses()))
+                    .Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+                    .Key("size"s).Value(static_cast<int>(route_cache.GetSize()))
+                .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict MakeRouteAlternativesDict(const RequestHandler& handler, const json::Node& requests) {
+    auto alternatives = handler.GetRouteAlternatives(requests.AsDict().at("from").AsString(), requests.AsDict().at("to").AsString());
+    
+    if (alternatives.empty()) {
+		return json::Builder{}
+					.StartDict()
+						.Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+						.Key("error_message"s).Value("not found"s)
+					.EndDict()
+				.Build()
+				.AsDict();
+    }
+    
+    json::Array routes;
+    for (const auto& [total_time, route_info] : alternatives) {
+        // пересадок на одну меньше, чем поездок
+        const int transfer_count = route_info.empty() ? 0 : static_cast<int>(route_info.size()) - 1;
+        routes.push_back(json::Builder{}
+                            .StartDict()
+                                .Key("items"s).Value(MakeRouteItems(route_info))
+                                .Key("total_time"s).Value(total_time)
+                                .Key("transfer_count"s).Value(transfer_count)
+                            .EndDict()
+                        .Build()
+                        .AsDict());
+    }
+    
+    return json::Builder{}
+                .StartDict()
+                    .Key("alternatives"s).Value(routes)
+                    .Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+                .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict MakeUpdateErrorDict(const json::Node& requests, const std::string& error_message) {
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+                    .Key("error_message"s).Value(error_message)
+                .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict MakeUpdateDict(RequestHandler& handler, const json::Node& requests) {
+    const json::Dict& request = requests.AsDict();
+    // аргументы проверяются до изменения каталога: ошибочный запрос не должен прерывать обработку остальных
+    if (!handler.CanUpdateRouter()) {
+        return MakeUpdateErrorDict(requests, "routing engine can't be updated"s);
+    }
+    size_t updated_edges = 0;
+    if (request.at("type").AsString() == "UpdateDistance") {
+        const std::string& from = request.at("from").AsString();
+        const std::string& to = request.at("to").AsString();
+        const double distance = request.at("distance").AsDouble();
+        if (!handler.FindStopId(from) || !handler.FindStopId(to)) {
+            return MakeUpdateErrorDict(requests, "not found"s);
+        }
+        if (distance < 0) {
+            return MakeUpdateErrorDict(requests, "distance should be non-negative"s);
+        }
+        updated_edges = handler.UpdateDistance(from, to, distance);
+    } else {
+        const int wait_time = request.at("bus_wait_time").AsInt();
+        const int bus_velocity = request.at("bus_velocity").AsInt();
+        if (wait_time < 0) {
+            return MakeUpdateErrorDict(requests, "bus_wait_time should be non-negative"s);
+        }
+        if (bus_velocity <= 0) {
+            return MakeUpdateErrorDict(requests, "bus_velocity should be positive"s);
+        }
+        updated_edges = handler.UpdateRoutingSetting(wait_time, bus_velocity);
+    }
+    
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id"s).Value(request.at("id").AsInt())
+                    .Key("updated_edges"s).Value(static_cast<int>(updated_edges))
+                .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict MakeRouteMatrixDict(const RequestHandler& handler, const json::Node& requests) {
+    auto to_names = [](const json::Node& stops) {
+        std::vector<std::string_view> names;
+        names.reserve(stops.AsArray().size());
+        for (auto& stop : stops.AsArray()) {
+            names.push_back(stop.AsString());
+        }
+        return names;
+    };
+    
+    auto anser = handler.GetRouteMatrix(to_names(requests.AsDict().at("from")), to_names(requests.AsDict().at("to")));
+    
+    if (!anser) {
+		return json::Builder{}
+					.StartDict()
+						.Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+						.Key("error_message"s).Value("not found"s)
+					.EndDict()
+				.Build()
+				.AsDict();
+    }
+    
+    json::Array total_times;
+    total_times.reserve(anser->size());
+    for (auto& row : *anser) {
+        json::Array times;
+        times.reserve(row.size());
+        for (auto& time : row) {
+            times.push_back(time ? json::Node(*time) : json::Node(nullptr));
+        }
+        total_times.push_back(std::move(times));
+    }
+    
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+                    .Key("total_times"s).Value(std::move(total_times))
+                .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict MakeIsochroneDict(const RequestHandler& handler, const json::Node& requests) {
+    auto anser = handler.GetIsochrone(requests.AsDict().at("from").AsString(), requests.AsDict().at("max_time").AsDouble());
+    
+    if (!anser) {
+		return json::Builder{}
+					.StartDict()
+						.Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+						.Key("error_message"s).Value("not found"s)
+					.EndDict()
+				.Build()
+				.AsDict();
+    }
+    
+    json::Array items;
+    items.reserve(anser->size());
+    for (const auto& [stop_name, time] : *anser) {
+        items.push_back(json::Builder{}
+                            .StartDict()
+                                .Key("stop_name"s).Value(std::string(stop_name))
+                                .Key("time"s).Value(time)
+                            .EndDict()
+                        .Build()
+                        .AsDict());
+    }
+    
+    return json::Builder{}
+                .StartDict()
+                    .Key("items"s).Value(std::move(items))
+                    .Key("request_id"s).Value(requests.AsDict().at("id").AsInt())
+                .EndDict()
+            .Build()
+            .AsDict();
+}
+
+void GetStatistic(RequestHandler& handler, const json::Node& stat_requests, std::ostream& out, size_t route_cache_capacity) {
 //     RequestHandler request(catalog);
     json::Array result;
 //     RequestHandler req(catalog);
+    RouteCache route_cache(route_cache_capacity);
     for (auto& request : stat_requests.AsArray()) {
 		auto req = request.AsDict();
         if (req.at("type").AsString() == "Bus") {
@@ -277,7 +569,20 @@ void GetStatistic(RequestHandler& handler, const json::Node& stat_requests, std:
 		  	handler.MakeRenderMap();
 			result.push_back(MakeMapDict(handler, request));
 		} else if (request.AsDict().at("type").AsString() == "Route") {
-			result.push_back(MakeRouteDict(handler, request));
+			result.push_back(MakeRouteDict(handler, request, route_cache));
+		} else if (request.AsDict().at("type").AsString() == "RouteAlternatives") {
+			result.push_back(MakeRouteAlternativesDict(handler, request));
+		} else if (request.AsDict().at("type").AsString() == "RouteCacheStat") {
+			result.push_back(MakeRouteCacheStatDict(route_cache, request));
+		} else if (request.AsDict().at("type").AsString() == "RouteMatrix") {
+			result.push_back(MakeRouteMatrixDict(handler, request));
+		} else if (request.AsDict().at("type").AsString() == "Isochrone") {
+			result.push_back(MakeIsochroneDict(handler, request));
+		} else if (request.AsDict().at("type").AsString() == "UpdateDistance"
+		           || request.AsDict().at("type").AsString() == "UpdateRoutingSettings") {
+			result.push_back(MakeUpdateDict(handler, request));
+			// ответы, построенные до изменения весов, устарели
+			route_cache.Clear();
 		}
     }
 	
@@ -335,6 +640,10 @@ void MakeBaseJSON(catalog::TransportCatalogue& catalog, map_renderer::MapRandere
     if (input_doc.GetRoot().AsDict().count("routing_settings")) {
 		auto routing_settings = input_doc.GetRoot().AsDict().at("routing_settings");
 		AddRoutingSettingInCatalog(catalog, routing_settings);
+		// RAPTOR ищет пути по последовательностям остановок маршрутов, граф ему не нужен
+		if (catalog.GetRoutingSetting().router_type != domain::RouterType::RAPTOR) {
+			BuildGraph(catalog);
+		}
 	}
 	
 	if (input_doc.GetRoot().AsDict().count("render_settings")) {
@@ -368,8 +677,17 @@ void ProcessRequestsJSON(catalog::TransportCatalogue& catalog, map_renderer::Map
     handler.DeserializeRenderMap();
 
 	if (input_doc.GetRoot().AsDict().count("stat_requests")) {
+		size_t route_cache_capacity = DEFAULT_ROUTE_CACHE_CAPACITY;
+		if (input_doc.GetRoot().AsDict().count("route_cache_settings")) {
+			const int capacity = input_doc.GetRoot().AsDict().at("route_cache_settings").AsDict().at("capacity").AsInt();
+			if (capacity < 0) {
+				throw std::invalid_argument("Route cache capacity should be non-negative");
+			}
+			route_cache_capacity = static_cast<size_t>(capacity);
+		}
+		
 		auto stat_requests = input_doc.GetRoot().AsDict().at("stat_requests");
-		GetStatistic(handler, stat_requests, out);
+		GetStatistic(handler, stat_requests, out, route_cache_capacity);
 	}
 	
 }
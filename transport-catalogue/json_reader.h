@@ -15,6 +15,7 @@
 */
 #pragma once
 
+#include <cstdint>
 #include <sstream>
 
 
@@ -24,9 +25,21 @@
 #include "request_handler.h"
 #include "map_renderer.h"
 #include "json_builder.h"
+#include "lru_cache.h"
 
 // #include "log_duration.h"
 
+/// Кэш готовых ответов на запросы Route (без request_id) по ключу пары номеров остановок MakeRouteCacheKey
+using RouteCache = cache::LruCache<std::uint64_t, json::Dict>;
+
+/// Ключ кэша ответов: номер остановки отправления в старших 32 битах, прибытия - в младших
+inline std::uint64_t MakeRouteCacheKey(size_t from, size_t to) {
+    return static_cast<std::uint64_t>(from) << 32 | static_cast<std::uint32_t>(to);
+}
+
+/// Размер кэша ответов на запросы Route по умолчанию
+constexpr size_t DEFAULT_ROUTE_CACHE_CAPACITY = 1024;
+
 /*!
 	* Обрабатывает json структуру содержащую запрос на добавление 
 	* остановки в каталог
@@ -110,7 +123,16 @@ std::variant<std::monostate, std::string, svg::Rgb, svg::Rgba> GetColor(json::No
 */
 void SetRenderSetting(map_renderer::MapRanderer& map, const json::Node& render_settings);
 
-
+/*!
+	* Устанавливает файл базы и формат, в котором она сохраняется
+	* 
+	* @param serialization ссылка на класс сериализации
+	* @param serialization_file json структура: "file" - путь к базе, "format" - "protobuf" (по умолчанию) или "flat"
+	* 
+	* @throw std::invalid_argument неизвестный формат
+	* 
+	* @return None
+*/
 void SetSerializationFile(serialization::Serialization& serialization, const json::Node& serialization_file);
 
 /*!
@@ -146,8 +168,19 @@ json::Dict MakeStopDict(const RequestHandler& handler, const json::Node& request
 */
 json::Dict MakeMapDict(const RequestHandler& handler, const json::Node& requests);
 
+/*!
+	* Формирует массив частей пути (ожидание и поездка на автобусе) для ответа на запрос о пути
+	* 
+	* @param route_info части пути
+	* 
+	* 
+	* @return json массив частей пути
+*/
+json::Array MakeRouteItems(const std::vector<domain::RouteInfo>& route_info);
+
 /*!
 	* Формирует ответ в json формате на запрос о пути между остановками
+	* (при заданном "departure_time" - по расписанию маршрутов)
 	* 
 	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
 	* @param requests запрос об остановке
@@ -157,16 +190,114 @@ json::Dict MakeMapDict(const RequestHandler& handler, const json::Node& requests
 */
 json::Dict MakeRouteDict(const RequestHandler& handler, const json::Node& requests);
 
+/*!
+	* Формирует ответ в json формате на запрос о пути по уже найденному пути
+	* 
+	* @param requests запрос о пути
+	* @param anser время в пути и его участки, std::nullopt - путь не найден
+	* 
+	* 
+	* @return json словарь с пути между остановками
+*/
+json::Dict MakeRouteAnswerDict(const json::Node& requests, const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>>& anser);
+
+/*!
+	* Формирует ответ на запрос о пути между остановками, используя кэш ранее построенных ответов
+	* (запросы по расписанию не кэшируются)
+	* 
+	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
+	* @param requests запрос об остановке
+	* @param route_cache кэш ответов по паре остановок
+	* 
+	* 
+	* @return json словарь с пути между остановками
+*/
+json::Dict MakeRouteDict(const RequestHandler& handler, const json::Node& requests, RouteCache& route_cache);
+
+/*!
+	* Формирует ответ в json формате на запрос статистики кэша ответов Route
+	* 
+	* @param route_cache кэш ответов по паре остановок
+	* @param requests запрос статистики
+	* 
+	* 
+	* @return json словарь с количеством попаданий, промахов, записей и размером кэша
+*/
+json::Dict MakeRouteCacheStatDict(const RouteCache& route_cache, const json::Node& requests);
+
+/*!
+	* Формирует ответ в json формате на запрос Парето-оптимальных путей между остановками
+	* 
+	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
+	* @param requests запрос с остановками from и to
+	* 
+	* 
+	* @return json словарь с массивом путей alternatives (по возрастанию числа пересадок transfer_count)
+	* или с error_message "not found", если пути нет или остановка не найдена
+*/
+json::Dict MakeRouteAlternativesDict(const RequestHandler& handler, const json::Node& requests);
+
+/*!
+	* Формирует ответ в json формате на ошибочный запрос изменения весов графа
+	* 
+	* @param requests запрос на изменение
+	* @param error_message описание ошибки
+	* 
+	* 
+	* @return json словарь с error_message
+*/
+json::Dict MakeUpdateErrorDict(const json::Node& requests, const std::string& error_message);
+
+/*!
+	* Применяет изменение весов графа маршрутов без его перестроения: запрос UpdateDistance
+	* (from, to, distance) или UpdateRoutingSettings (bus_wait_time, bus_velocity)
+	* 
+	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
+	* @param requests запрос на изменение
+	* 
+	* 
+	* @return json словарь с количеством ребер графа с измененным весом updated_edges
+	* или с error_message, если выбранный движок маршрутов нельзя обновить без make_base,
+	* остановка не найдена или новые расстояние и настройки недопустимы
+*/
+json::Dict MakeUpdateDict(RequestHandler& handler, const json::Node& requests);
+
+/*!
+	* Формирует ответ в json формате на запрос времени в пути между всеми парами остановок
+	* 
+	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
+	* @param requests запрос с массивами остановок отправления from и прибытия to
+	* 
+	* 
+	* @return json словарь с матрицей времени в пути total_times (null - маршрута нет)
+	* или с error_message "not found", если одна из остановок не найдена
+*/
+json::Dict MakeRouteMatrixDict(const RequestHandler& handler, const json::Node& requests);
+
+/*!
+	* Формирует ответ в json формате на запрос остановок, до которых можно доехать за отведенное время
+	* 
+	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
+	* @param requests запрос с остановкой отправления from и временем в пути max_time (мин.)
+	* 
+	* 
+	* @return json словарь с массивом остановок items (stop_name и time) по возрастанию времени в пути
+	* или с error_message "not found", если остановка не найдена или max_time отрицательно
+*/
+json::Dict MakeIsochroneDict(const RequestHandler& handler, const json::Node& requests);
+
 /*!
 	* Выдает статистику о маршрутах, остановках и выводит из в out
 	* 
 	* @param handler ссылка на класс содержащий информацию о транспрортном справочкике и ссылку на карту
 	* @param stat_requests массив запросов
 	* @param out выходной поток
+	* @param route_cache_capacity размер кэша ответов на запросы Route (0 - без кэша)
 	* 
 	* @return None
 */
-void GetStatistic(RequestHandler& handler, const json::Node& stat_requests, std::ostream& out);
+void GetStatistic(RequestHandler& handler, const json::Node& stat_requests, std::ostream& out, 
+                  size_t route_cache_capacity = DEFAULT_ROUTE_CACHE_CAPACITY);
 
 /*!
 	* Формирует json массив из входного потока и передает управление функциям обработчикам запросов на заполнение каталога.
@@ -0,0 +1,224 @@
+/*!
+ * @file landmarks.h
+ * @brief Заголовочный файл с эвристикой ориентиров (ALT) для поиска A*
+ *
+ * Для нескольких вершин-ориентиров L заранее считаются веса путей d(L, v) и d(v, L)
+ * до всех вершин графа. По неравенству треугольника вес пути из v в t не меньше
+ * d(L, t) - d(L, v) и d(v, L) - d(t, L); максимум этих оценок по всем ориентирам -
+ * согласованная эвристика для graph::AStarRouter.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include "graph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/// Ориентиры и веса путей между ними и всеми вершинами графа
+template <typename Weight>
+struct LandmarkData {
+    size_t vertex_count = 0;
+    std::vector<VertexId> landmarks;
+    std::vector<Weight> from_landmarks;     ///< d(landmarks[i], v) в ячейке i * vertex_count + v, бесконечность - пути нет
+    std::vector<Weight> to_landmarks;       ///< d(v, landmarks[i]) в ячейке i * vertex_count + v, бесконечность - пути нет
+};
+
+template <typename Weight>
+class LandmarkHeuristic {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    /// Выбирает не больше landmark_count ориентиров и считает веса путей до них
+    LandmarkHeuristic(const Graph& graph, size_t landmark_count);
+
+    /// Эвристика по заранее посчитанным ориентирам (например, загруженным из базы)
+    LandmarkHeuristic(const Graph& graph, LandmarkData<Weight> data);
+
+    Weight operator()(VertexId vertex, VertexId to) const;
+
+    const LandmarkData<Weight>& GetLandmarkData() const;
+
+private:
+    /// Дуги графа в одном направлении, сгруппированные по начальной вершине
+    struct Arcs {
+        std::vector<size_t> offsets;
+        std::vector<VertexId> targets;
+        std::vector<Weight> weights;
+    };
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::infinity();
+
+    static Arcs MakeArcs(const Graph& graph, bool reversed);
+
+    /// Веса путей из source во все вершины по дугам arcs (поиск Дейкстры без ранней остановки)
+    static std::vector<Weight> ComputeWeights(const Arcs& arcs, VertexId source);
+
+    LandmarkData<Weight> data_;
+};
+
+template <typename Weight>
+LandmarkHeuristic<Weight>::LandmarkHeuristic(const Graph& graph, size_t landmark_count) {
+    static_assert(std::numeric_limits<Weight>::has_infinity, "Weight should have an infinity value");
+
+    const size_t vertex_count = graph.GetVertexCount();
+    data_.vertex_count = vertex_count;
+    if (vertex_count == 0) {
+        return;
+    }
+
+    const Arcs forward_arcs = MakeArcs(graph, false);
+    const Arcs backward_arcs = MakeArcs(graph, true);
+
+    // ориентирами выбираются только вершины, из которых выходят ребра (изолированные
+    // остановки бесполезны); каждый следующий ориентир - "самая дальняя" вершина, то есть
+    // с наибольшим весом пути от ближайшего уже выбранного ориентира. Недостижимые вершины
+    // считаются самыми дальними, чтобы ориентиры попали в разные компоненты графа
+    auto find_farthest = [&](const std::vector<Weight>& weights) -> std::optional<VertexId> {
+        std::optional<VertexId> farthest;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (forward_arcs.offsets[vertex] == forward_arcs.offsets[vertex + 1]
+                || std::find(data_.landmarks.begin(), data_.landmarks.end(), vertex) != data_.landmarks.end()) {
+                continue;
+            }
+            if (!farthest || weights[vertex] > weights[*farthest]) {
+                farthest = vertex;
+            }
+        }
+        return farthest;
+    };
+
+    // первый ориентир - самая дальняя вершина от произвольной вершины с ребрами
+    std::optional<VertexId> next_landmark;
+    for (VertexId vertex = 0; vertex < vertex_count && !next_landmark; ++vertex) {
+        if (forward_arcs.offsets[vertex] != forward_arcs.offsets[vertex + 1]) {
+            next_landmark = find_farthest(ComputeWeights(forward_arcs, vertex));
+        }
+    }
+
+    std::vector<Weight> nearest_landmark_weights(vertex_count, INFINITE_WEIGHT);
+    while (next_landmark && data_.landmarks.size() < landmark_count) {
+        data_.landmarks.push_back(*next_landmark);
+        const std::vector<Weight> weights = ComputeWeights(forward_arcs, *next_landmark);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            nearest_landmark_weights[vertex] = std::min(nearest_landmark_weights[vertex], weights[vertex]);
+        }
+        data_.from_landmarks.insert(data_.from_landmarks.end(), weights.begin(), weights.end());
+        next_landmark = find_farthest(nearest_landmark_weights);
+    }
+
+    // пути до ориентиров - это пути от них по обратным дугам, ориентиры независимы
+    const size_t chosen_count = data_.landmarks.size();
+    data_.to_landmarks.resize(chosen_count * vertex_count);
+    parallel::ForEachRange(chosen_count, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const std::vector<Weight> weights = ComputeWeights(backward_arcs, data_.landmarks[i]);
+            std::copy(weights.begin(), weights.end(), data_.to_landmarks.begin() + i * vertex_count);
+        }
+    });
+}
+
+template <typename Weight>
+LandmarkHeuristic<Weight>::LandmarkHeuristic(const Graph& graph, LandmarkData<Weight> data)
+    : data_(std::move(data))
+{
+    const size_t cell_count = data_.landmarks.size() * data_.vertex_count;
+    if (data_.vertex_count != graph.GetVertexCount() || data_.from_landmarks.size() != cell_count 
+        || data_.to_landmarks.size() != cell_count) {
+        throw std::invalid_argument("Landmark data doesn't match the graph");
+    }
+}
+
+template <typename Weight>
+typename LandmarkHeuristic<Weight>::Arcs LandmarkHeuristic<Weight>::MakeArcs(const Graph& graph, bool reversed) {
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+
+    Arcs arcs;
+    arcs.offsets.assign(vertex_count + 1, 0);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto edge = graph.GetEdge(edge_id);
+        ++arcs.offsets[(reversed ? edge.to : edge.from) + 1];
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        arcs.offsets[vertex + 1] += arcs.offsets[vertex];
+    }
+
+    arcs.targets.resize(edge_count);
+    arcs.weights.resize(edge_count);
+    std::vector<size_t> positions(arcs.offsets.begin(), arcs.offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto edge = graph.GetEdge(edge_id);
+        const size_t position = positions[reversed ? edge.to : edge.from]++;
+        arcs.targets[position] = reversed ? edge.from : edge.to;
+        arcs.weights[position] = edge.weight;
+    }
+    return arcs;
+}
+
+template <typename Weight>
+std::vector<Weight> LandmarkHeuristic<Weight>::ComputeWeights(const Arcs& arcs, VertexId source) {
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    std::vector<Weight> weights(arcs.offsets.size() - 1, INFINITE_WEIGHT);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    weights[source] = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, source});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weights[vertex] < weight) {
+            continue;
+        }
+        for (size_t arc = arcs.offsets[vertex]; arc < arcs.offsets[vertex + 1]; ++arc) {
+            const Weight candidate_weight = weight + arcs.weights[arc];
+            if (candidate_weight < weights[arcs.targets[arc]]) {
+                weights[arcs.targets[arc]] = candidate_weight;
+                queue.push({candidate_weight, arcs.targets[arc]});
+            }
+        }
+    }
+    return weights;
+}
+
+template <typename Weight>
+Weight LandmarkHeuristic<Weight>::operator()(VertexId vertex, VertexId to) const {
+    const size_t vertex_count = data_.vertex_count;
+    Weight estimate = ZERO_WEIGHT;
+    for (size_t i = 0; i < data_.landmarks.size(); ++i) {
+        const Weight* from_landmark = data_.from_landmarks.data() + i * vertex_count;
+        const Weight* to_landmark = data_.to_landmarks.data() + i * vertex_count;
+
+        // оценки с бесконечными слагаемыми ничего не говорят о пути
+        if (from_landmark[to] != INFINITE_WEIGHT && from_landmark[vertex] != INFINITE_WEIGHT) {
+            estimate = std::max(estimate, from_landmark[to] - from_landmark[vertex]);
+        }
+        if (to_landmark[vertex] != INFINITE_WEIGHT && to_landmark[to] != INFINITE_WEIGHT) {
+            estimate = std::max(estimate, to_landmark[vertex] - to_landmark[to]);
+        }
+    }
+    return estimate;
+}
+
+template <typename Weight>
+const LandmarkData<Weight>& LandmarkHeuristic<Weight>::GetLandmarkData() const {
+    return data_;
+}
+
+}  // namespace graph
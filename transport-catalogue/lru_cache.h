@@ -0,0 +1,97 @@
+/*!
+ * @file lru_cache.h
+ * @brief Заголовочный файл с ограниченным кэшем, вытесняющим давно не использованные записи (LRU)
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    /// capacity - максимальное количество записей, 0 - кэш отключен
+    explicit LruCache(size_t capacity)
+        : capacity_(capacity)
+    {
+    }
+
+    /*!
+     * Ищет запись по ключу и делает ее самой свежей
+     *
+     * @return указатель на значение (действителен до следующего Insert) или nullptr, если записи нет
+     */
+    const Value* Find(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++misses_;
+            return nullptr;
+        }
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->second;
+    }
+
+    /// Добавляет (или заменяет) запись, при переполнении вытесняет самую старую
+    void Insert(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        if (auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(key, entries_.begin());
+    }
+
+    /// Удаляет все записи (счетчики поисков сохраняются)
+    void Clear() {
+        entries_.clear();
+        index_.clear();
+    }
+
+    size_t GetCapacity() const {
+        return capacity_;
+    }
+
+    size_t GetSize() const {
+        return entries_.size();
+    }
+
+    /// Количество успешных поисков Find
+    size_t GetHits() const {
+        return hits_;
+    }
+
+    /// Количество неудачных поисков Find
+    size_t GetMisses() const {
+        return misses_;
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    size_t capacity_;
+    Entries entries_;                                                   ///< Записи от самой свежей к самой старой
+    std::unordered_map<Key, typename Entries::iterator, Hash> index_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+}  // namespace cache
@@ -0,0 +1,73 @@
+/*!
+ * @file name_index.h
+ * @brief Заголовочный файл со словарем названий, выдающим плотные номера
+ *
+ * Название хешируется один раз - при переводе в номер, все внутренние индексы каталога
+ * хранят номера и обращаются к векторам, а не к хеш-таблицам строк.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace catalog {
+
+class NameIndex {
+public:
+    using Id = std::uint32_t;
+
+    /*!
+     * Добавляет название и возвращает его номер (номера выдаются подряд с нуля)
+     *
+     * Строка, на которую указывает name, должна жить дольше словаря
+     */
+    Id Add(std::string_view name) {
+        auto [it, inserted] = ids_.emplace(name, static_cast<Id>(names_.size()));
+        if (inserted) {
+            names_.push_back(name);
+        }
+        return it->second;
+    }
+
+    /// Номер названия, std::nullopt - названия нет
+    std::optional<Id> Find(std::string_view name) const {
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /// Номер названия, std::out_of_range - названия нет
+    Id At(std::string_view name) const {
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            throw std::out_of_range("Unknown name " + std::string(name));
+        }
+        return it->second;
+    }
+
+    std::string_view GetName(Id id) const {
+        return names_.at(id);
+    }
+
+    size_t Size() const {
+        return names_.size();
+    }
+
+private:
+    std::unordered_map<std::string_view, Id> ids_;
+    std::vector<std::string_view> names_;
+};
+
+}  // namespace catalog
@@ -0,0 +1,66 @@
+/*!
+ * @file parallel.h
+ * @brief Заголовочный файл с функциями для параллельной обработки диапазонов
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+/*!
+ * Возвращает количество потоков для обработки count независимых элементов
+ *
+ * @param count количество элементов
+ *
+ * @return от 1 до количества аппаратных потоков, но не больше count
+ */
+inline size_t GetThreadCount(size_t count) {
+    return std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count));
+}
+
+/*!
+ * Делит [0, count) на thread_count непрерывных диапазонов и вызывает
+ * func(thread_index, begin, end) для каждого из них в отдельном потоке.
+ * Нулевой диапазон обрабатывается в вызывающем потоке.
+ *
+ * @param count количество элементов
+ * @param thread_count количество диапазонов (потоков)
+ * @param func обработчик диапазона
+ *
+ * @return None
+ */
+template <typename Func>
+void ForEachRange(size_t count, size_t thread_count, Func func) {
+    auto process = [count, thread_count, &func](size_t thread_index) {
+        func(thread_index, count * thread_index / thread_count, count * (thread_index + 1) / thread_count);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count > 0 ? thread_count - 1 : 0);
+    for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+        workers.emplace_back(process, thread_index);
+    }
+    if (thread_count > 0) {
+        process(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/// То же, что и ForEachRange, с количеством потоков GetThreadCount(count)
+template <typename Func>
+void ForEachRange(size_t count, Func func) {
+    ForEachRange(count, GetThreadCount(count), func);
+}
+
+}  // namespace parallel
@@ -0,0 +1,216 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+using namespace raptor;
+
+RaptorRouter::RaptorRouter(std::vector<domain::RoutePattern> patterns, const domain::RoutingSetting& routing_setting)
+    : patterns_(std::move(patterns))
+    , wait_time_(routing_setting.wait_time)
+    , bus_velocity_(routing_setting.bus_velocity * 1000.0 / 60)
+    , route_criterion_(routing_setting.route_criterion)
+{
+    for (const auto& pattern : patterns_) {
+        for (size_t stop : pattern.stops) {
+            stop_count_ = std::max(stop_count_, stop + 1);
+        }
+    }
+
+    // индекс "остановка -> последовательности через нее" в виде CSR
+    stop_pattern_offsets_.assign(stop_count_ + 1, 0);
+    for (const auto& pattern : patterns_) {
+        for (size_t stop : pattern.stops) {
+            ++stop_pattern_offsets_[stop + 1];
+        }
+    }
+    for (size_t stop = 0; stop < stop_count_; ++stop) {
+        stop_pattern_offsets_[stop + 1] += stop_pattern_offsets_[stop];
+    }
+
+    stop_patterns_.resize(stop_pattern_offsets_.back());
+    std::vector<size_t> positions(stop_pattern_offsets_.begin(), stop_pattern_offsets_.end() - 1);
+    for (size_t pattern = 0; pattern < patterns_.size(); ++pattern) {
+        const auto& stops = patterns_[pattern].stops;
+        for (size_t position = 0; position < stops.size(); ++position) {
+            stop_patterns_[positions[stops[position]]++] = {static_cast<std::uint32_t>(pattern), static_cast<std::uint32_t>(position)};
+        }
+    }
+}
+
+double RaptorRouter::GetRideTime(const domain::RoutePattern& pattern, size_t board, size_t alight) const {
+    return (pattern.distances[alight] - pattern.distances[board]) / bus_velocity_ + wait_time_;
+}
+
+std::vector<std::vector<RaptorRouter::Label>> RaptorRouter::Scan(size_t from, std::optional<size_t> target, bool stop_at_target, 
+                                                                  double max_time) const {
+    std::vector<std::vector<Label>> labels(1, std::vector<Label>(stop_count_));
+    labels[0][from].time = 0;
+
+    // лучшее время по всем раундам: метка раунда обновляется, только если она его улучшает
+    std::vector<double> best_times(stop_count_, NOT_REACHED);
+    best_times[from] = 0;
+
+    std::vector<size_t> marked_stops{from};
+    std::vector<std::uint32_t> first_positions(patterns_.size(), NO_POSITION);
+    std::vector<size_t> queued_patterns;
+    std::vector<bool> is_marked(stop_count_, false);
+
+    while (!marked_stops.empty()) {
+        // последовательности через улучшенные остановки просматриваются с самой ранней из них
+        for (size_t stop : marked_stops) {
+            is_marked[stop] = false;
+            for (size_t i = stop_pattern_offsets_[stop]; i < stop_pattern_offsets_[stop + 1]; ++i) {
+                const auto [pattern, position] = stop_patterns_[i];
+                if (first_positions[pattern] == NO_POSITION) {
+                    queued_patterns.push_back(pattern);
+                }
+                first_positions[pattern] = std::min(first_positions[pattern], position);
+            }
+        }
+        marked_stops.clear();
+
+        const std::uint32_t round = static_cast<std::uint32_t>(labels.size());
+        labels.push_back(labels.back());
+        const std::vector<Label>& prev_labels = labels[round - 1];
+        std::vector<Label>& labels_round = labels[round];
+
+        for (size_t pattern_index : queued_patterns) {
+            const domain::RoutePattern& pattern = patterns_[pattern_index];
+            std::uint32_t board = NO_POSITION;
+            double board_time = NOT_REACHED;
+
+            for (std::uint32_t position = first_positions[pattern_index]; position < pattern.stops.size(); ++position) {
+                const size_t stop = pattern.stops[position];
+
+                if (board != NO_POSITION) {
+                    const double time = board_time + GetRideTime(pattern, board, position);
+                    const double target_time = target ? best_times[*target] : NOT_REACHED;
+                    if (time < best_times[stop] && time < target_time && time <= max_time) {
+                        best_times[stop] = time;
+                        labels_round[stop] = {time, round, static_cast<std::uint32_t>(pattern_index), board, position};
+                        if (!is_marked[stop]) {
+                            is_marked[stop] = true;
+                            marked_stops.push_back(stop);
+                        }
+                    }
+                }
+
+                // пересесть на этот автобус здесь выгоднее, если с остановки до конца
+                // последовательности доедем раньше, чем от прежней остановки посадки
+                const double stop_time = prev_labels[stop].time;
+                if (stop_time != NOT_REACHED
+                    && (board == NO_POSITION
+                        || stop_time - pattern.distances[position] / bus_velocity_ < board_time - pattern.distances[board] / bus_velocity_)) {
+                    board = position;
+                    board_time = stop_time;
+                }
+            }
+            first_positions[pattern_index] = NO_POSITION;
+        }
+        queued_patterns.clear();
+
+        if (stop_at_target && target && best_times[*target] != NOT_REACHED) {
+            break;
+        }
+    }
+
+    return labels;
+}
+
+std::optional<Journey> RaptorRouter::BuildJourney(size_t from, size_t to) const {
+    if (from == to) {
+        return Journey{0, {}};
+    }
+    if (from >= stop_count_ || to >= stop_count_) {
+        return std::nullopt;
+    }
+
+    const auto labels = Scan(from, to, route_criterion_ == domain::RouteCriterion::MIN_TRANSFERS);
+    Label label = labels.back()[to];
+    if (label.time == NOT_REACHED) {
+        return std::nullopt;
+    }
+
+    return MakeJourney(labels, label);
+}
+
+std::vector<Journey> RaptorRouter::BuildJourneys(size_t from, size_t to) const {
+    if (from == to) {
+        return {Journey{0, {}}};
+    }
+    if (from >= stop_count_ || to >= stop_count_) {
+        return {};
+    }
+
+    // метка остановки прибытия, найденная в раунде k, быстрее всех маршрутов с меньшим числом поездок
+    const auto labels = Scan(from, to, false);
+    std::vector<Journey> journeys;
+    for (size_t round = 1; round < labels.size(); ++round) {
+        if (labels[round][to].round == round) {
+            journeys.push_back(MakeJourney(labels, labels[round][to]));
+        }
+    }
+    return journeys;
+}
+
+Journey RaptorRouter::MakeJourney(const std::vector<std::vector<Label>>& labels, Label label) const {
+    Journey journey;
+    journey.total_time = label.time;
+    while (label.round > 0) {
+        const domain::RoutePattern& pattern = patterns_[label.pattern];
+        const size_t board_stop = pattern.stops[label.board_position];
+
+        Leg leg;
+        leg.board_stop = board_stop;
+        leg.bus = pattern.bus;
+        leg.span_count = static_cast<int>(label.alight_position - label.board_position);
+        leg.time = GetRideTime(pattern, label.board_position, label.alight_position);
+        journey.legs.push_back(leg);
+
+        // посадка была по метке предыдущего раунда
+        label = labels[label.round - 1][board_stop];
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+
+    return journey;
+}
+
+std::vector<std::optional<double>> RaptorRouter::BuildTimes(size_t from, const std::vector<size_t>& to) const {
+    std::vector<std::optional<double>> times(to.size());
+    if (from >= stop_count_) {
+        for (size_t i = 0; i < to.size(); ++i) {
+            if (to[i] == from) {
+                times[i] = 0;
+            }
+        }
+        return times;
+    }
+
+    const auto labels = Scan(from, std::nullopt, false);
+    for (size_t i = 0; i < to.size(); ++i) {
+        if (to[i] < stop_count_ && labels.back()[to[i]].time != NOT_REACHED) {
+            times[i] = labels.back()[to[i]].time;
+        }
+    }
+    return times;
+}
+
+std::vector<std::pair<size_t, double>> RaptorRouter::BuildReachableTimes(size_t from, double max_time) const {
+    if (from >= stop_count_) {
+        return {{from, 0}};
+    }
+
+    const auto labels = Scan(from, std::nullopt, false, max_time);
+    std::vector<std::pair<size_t, double>> reachable;
+    for (size_t stop = 0; stop < stop_count_; ++stop) {
+        if (labels.back()[stop].time != NOT_REACHED) {
+            reachable.emplace_back(stop, labels.back()[stop].time);
+        }
+    }
+    std::sort(reachable.begin(), reachable.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+    });
+    return reachable;
+}
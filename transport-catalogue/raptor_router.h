@@ -0,0 +1,110 @@
+/*!
+ * @file raptor_router.h
+ * @brief Заголовочный файл с поиском маршрутов по последовательностям остановок (RAPTOR)
+ *
+ * Поиск идет раундами: в раунде k находятся самые быстрые маршруты, в которых не больше
+ * k поездок. В каждом раунде просматриваются только последовательности остановок, проходящие
+ * через остановки, улучшенные в предыдущем раунде, поэтому граф маршрутов с O(k^2) ребрами
+ * на маршрут не нужен. Время проезда считается так же, как веса ребер графа STOP_PAIRS.
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "domain.h"
+
+namespace raptor {
+
+/// Поездка на одном автобусе
+struct Leg {
+    size_t board_stop;                  ///< Номер остановки посадки
+    const domain::Bus* bus;             ///< Маршрут
+    int span_count;                     ///< Количество проезжаемых перегонов
+    double time;                        ///< Ожидание автобуса и время в пути (мин.)
+};
+
+/// Найденный маршрут
+struct Journey {
+    double total_time;                  ///< Время в пути (мин.)
+    std::vector<Leg> legs;
+};
+
+class RaptorRouter {
+public:
+    RaptorRouter() = default;
+
+    RaptorRouter(std::vector<domain::RoutePattern> patterns, const domain::RoutingSetting& routing_setting);
+
+    /// Маршрут между остановками по критерию из настроек, std::nullopt - маршрута нет
+    std::optional<Journey> BuildJourney(size_t from, size_t to) const;
+
+    /*!
+     * Парето-оптимальные маршруты между остановками: для каждого числа поездок - самый быстрый
+     * маршрут, если он быстрее всех маршрутов с меньшим числом поездок
+     *
+     * @return маршруты по возрастанию числа поездок (и убыванию времени в пути), пусто - маршрута нет
+     */
+    std::vector<Journey> BuildJourneys(size_t from, size_t to) const;
+
+    /// Время в пути из from до каждой остановки to (один поиск на все), std::nullopt - маршрута нет
+    std::vector<std::optional<double>> BuildTimes(size_t from, const std::vector<size_t>& to) const;
+
+    /// Остановки, до которых из from можно доехать не дольше max_time, и время в пути до них (по возрастанию)
+    std::vector<std::pair<size_t, double>> BuildReachableTimes(size_t from, double max_time) const;
+
+private:
+    static constexpr double NOT_REACHED = std::numeric_limits<double>::infinity();
+    static constexpr std::uint32_t NO_POSITION = std::numeric_limits<std::uint32_t>::max();
+
+    /// Лучшее время прибытия на остановку и последняя поездка к ней
+    struct Label {
+        double time = NOT_REACHED;
+        std::uint32_t round = 0;            ///< Раунд, в котором найдено время (0 - остановка отправления)
+        std::uint32_t pattern = 0;
+        std::uint32_t board_position = 0;   ///< Позиции посадки и высадки в последовательности pattern
+        std::uint32_t alight_position = 0;
+    };
+
+    /// Последовательность остановки и позиция остановки в ней
+    struct StopPattern {
+        std::uint32_t pattern;
+        std::uint32_t position;
+    };
+
+    /*!
+     * Поиск из остановки from
+     *
+     * @param target остановка прибытия для отсечения заведомо худших маршрутов (std::nullopt - все остановки)
+     * @param stop_at_target закончить поиск на первом раунде, в котором найден маршрут до target
+     * @param max_time маршруты дольше max_time отбрасываются
+     *
+     * @return метки остановок после каждого раунда
+     */
+    std::vector<std::vector<Label>> Scan(size_t from, std::optional<size_t> target, bool stop_at_target, 
+                                         double max_time = NOT_REACHED) const;
+
+    /// Восстанавливает маршрут по метке остановки прибытия
+    Journey MakeJourney(const std::vector<std::vector<Label>>& labels, Label label) const;
+
+    /// Ожидание и время проезда от позиции board до позиции alight последовательности pattern
+    double GetRideTime(const domain::RoutePattern& pattern, size_t board, size_t alight) const;
+
+    std::vector<domain::RoutePattern> patterns_;
+    std::vector<size_t> stop_pattern_offsets_;      ///< Последовательности остановки s: [offsets[s], offsets[s + 1]) в stop_patterns_
+    std::vector<StopPattern> stop_patterns_;
+    size_t stop_count_ = 0;                         ///< Наибольший номер остановки в последовательностях + 1
+    double wait_time_ = 0;
+    double bus_velocity_ = 0;                       ///< Скорость автобуса (м/мин.)
+    domain::RouteCriterion route_criterion_ = domain::RouteCriterion::MIN_TIME;
+};
+
+}  // namespace raptor
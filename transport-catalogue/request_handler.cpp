@@ -12,17 +12,41 @@ const std::optional<std::vector<std::string_view>> RequestHandler::GetBusesBySto
 
 /// Возвращаем информацию о пути
 const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> RequestHandler::GetRouter(const std::string_view& stop_from, const std::string_view& stop_to) const {
-    const auto from = db_.GetStopId(stop_from);
-    const auto to = db_.GetStopId(stop_to);
-    auto router = transport_router_.GetRouter(from, to);
+    auto from = db_.FindStopId(stop_from);
+    auto to = db_.FindStopId(stop_to);
+    if (!from || !to) {
+        return {};
+    }
+    return GetRouter(*from, *to);
+}
+
+const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> RequestHandler::GetRouter(size_t stop_from, size_t stop_to) const {
+    auto router = transport_router_.GetRouter(stop_from, stop_to);
     
     if (!router) {
         return {};
     }
     
-    auto vector_info = std::get<1>(router.value());
-    
+    return  std::make_tuple(std::get<0>(router.value()), MakeRouteInfo(std::get<1>(router.value())));
+}
+
+std::vector<std::tuple<double, std::vector<domain::RouteInfo>>> RequestHandler::GetRouteAlternatives(const std::string_view& stop_from, 
+                                                                                                    const std::string_view& stop_to) const {
+    std::vector<std::tuple<double, std::vector<domain::RouteInfo>>> alternatives;
+    auto from = db_.FindStopId(stop_from);
+    auto to = db_.FindStopId(stop_to);
+    if (!from || !to) {
+        return alternatives;
+    }
+    for (const auto& [total_time, vector_info] : transport_router_.GetRouteAlternatives(*from, *to)) {
+        alternatives.emplace_back(total_time, MakeRouteInfo(vector_info));
+    }
+    return alternatives;
+}
+
+std::vector<domain::RouteInfo> RequestHandler::MakeRouteInfo(const std::vector<transport_router::RouteInfo>& vector_info) const {
     std::vector<domain::RouteInfo> anser;
+    anser.reserve(vector_info.size());
     
     int wait_time = db_.GetWaitTime();
     
@@ -37,8 +61,142 @@ const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> RequestH
         anser.push_back(added_anser);
     }
     
+    return anser;
+}
+
+const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> RequestHandler::GetRouter(const std::string_view& stop_from, const std::string_view& stop_to, 
+                                                                                                  int departure_time) const {
+    auto from = db_.FindStopId(stop_from);
+    auto to = db_.FindStopId(stop_to);
+    if (!from || !to) {
+        return {};
+    }
+    auto journey = timetable_router_.BuildJourney(*from, *to, departure_time);
+    
+    if (!journey) {
+        return {};
+    }
+    
+    std::vector<domain::RouteInfo> anser;
+    anser.reserve(journey->legs.size());
+    
+    for (auto& leg : journey->legs) {
+        domain::RouteInfo added_anser;
+        added_anser.wait_stop = db_.GetStopNameFromId(leg.board_stop);
+        added_anser.wait_time = leg.wait_time;
+        added_anser.bus_name = leg.bus->bus;
+        added_anser.span_count = leg.span_count;
+        added_anser.time = leg.time;
+        
+        anser.push_back(added_anser);
+    }
+    
+    return std::make_tuple(journey->arrival_time - departure_time, anser);
+}
+    
+transport_router::PrecomputedData RequestHandler::MakePrecomputedData(const catalog::TransportCatalogue& catalog, 
+                                                                     serialization::Serialization& serialization) {
+    transport_router::PrecomputedData precomputed = serialization.ExtractRouterData();
+    transport_router::PrecomputedData catalog_data = MakeCatalogData(catalog);
+    precomputed.geo_bound = std::move(catalog_data.geo_bound);
+    precomputed.route_patterns = std::move(catalog_data.route_patterns);
+    return precomputed;
+}
+
+transport_router::PrecomputedData RequestHandler::MakeCatalogData(const catalog::TransportCatalogue& catalog) {
+    transport_router::PrecomputedData catalog_data;
+    if (catalog.GetRoutingSetting().router_type == domain::RouterType::A_STAR) {
+        catalog_data.geo_bound = catalog.GetGeoBound();
+    }
+    // последовательности остановок строятся за один проход по маршрутам и нужны не только RAPTOR,
+    // но и запросу RouteAlternatives
+    catalog_data.route_patterns = catalog.GetRoutePatterns();
+    return catalog_data;
+}
+
+/// Изменяем расстояние между остановками
+bool RequestHandler::CanUpdateRouter() const {
+    return transport_router_.CanUpdateEdgeWeights(db_.GetRoutingSetting());
+}
+
+size_t RequestHandler::UpdateDistance(const std::string_view& stop_from, const std::string_view& stop_to, double distance) {
+    // каталог меняется только вместе с движком маршрутов
+    if (!CanUpdateRouter()) {
+        throw std::logic_error("Routing engine can't be updated without rebuilding the base");
+    }
+    auto departure_stop = db_.FindStop(std::string(stop_from));
+    auto arrival_stop = db_.FindStop(std::string(stop_to));
+    if (departure_stop == nullptr || arrival_stop == nullptr) {
+        throw std::invalid_argument("Unknown stop in distance update");
+    }
+    if (distance < 0) {
+        throw std::invalid_argument("Distance between stops should be non-negative");
+    }
+    return ApplyEdgeWeightChanges(db_.UpdateDistance(departure_stop, arrival_stop, distance));
+}
+
+/// Изменяем время ожидания и скорость автобуса
+size_t RequestHandler::UpdateRoutingSetting(int wait_time, int bus_velocity) {
+    if (wait_time < 0 || bus_velocity <= 0) {
+        throw std::invalid_argument("Wait time should be non-negative and bus velocity should be positive");
+    }
+    if (!CanUpdateRouter()) {
+        throw std::logic_error("Routing engine can't be updated without rebuilding the base");
+    }
+    return ApplyEdgeWeightChanges(db_.UpdateRoutingSetting(wait_time, bus_velocity));
+}
+
+size_t RequestHandler::ApplyEdgeWeightChanges(const std::vector<graph::EdgeWeightChange<double>>& changes) {
+    transport_router_.UpdateEdgeWeights(changes, db_.GetRoutingSetting(), MakeCatalogData(db_));
+    return changes.size();
+}
+
+/// Возвращаем номер остановки по ее названию
+std::optional<size_t> RequestHandler::FindStopId(const std::string_view& stop_name) const {
+    return db_.FindStopId(stop_name);
+}
+
+/// Возвращаем время в пути между всеми парами остановок
+std::optional<std::vector<std::vector<std::optional<double>>>> RequestHandler::GetRouteMatrix(const std::vector<std::string_view>& stops_from, 
+                                                                                              const std::vector<std::string_view>& stops_to) const {
+    // названия остановок переводятся в номера один раз на весь запрос
+    auto find_ids = [this](const std::vector<std::string_view>& stops) -> std::optional<std::vector<graph::VertexId>> {
+        std::vector<graph::VertexId> ids;
+        ids.reserve(stops.size());
+        for (auto stop : stops) {
+            auto id = db_.FindStopId(stop);
+            if (!id) {
+                return std::nullopt;
+            }
+            ids.push_back(*id);
+        }
+        return ids;
+    };
+    
+    auto from_ids = find_ids(stops_from);
+    auto to_ids = find_ids(stops_to);
+    if (!from_ids || !to_ids) {
+        return {};
+    }
+    return transport_router_.GetRouteMatrix(*from_ids, *to_ids);
+}
+
+/// Возвращаем остановки, до которых можно доехать за отведенное время
+std::optional<std::vector<std::pair<std::string_view, double>>> RequestHandler::GetIsochrone(const std::string_view& stop_from, double max_time) const {
+    auto from = db_.FindStopId(stop_from);
+    if (!from || max_time < 0) {
+        return {};
+    }
     
-    return  std::make_tuple(std::get<0>(router.value()), anser);
+    // в модели RIDE_VERTICES за остановками идут вершины поездок, они в ответ не попадают
+    const size_t stop_count = db_.GetStopCount();
+    std::vector<std::pair<std::string_view, double>> anser;
+    for (const auto& [vertex, time] : transport_router_.GetIsochrone(*from, max_time)) {
+        if (vertex < stop_count) {
+            anser.emplace_back(db_.GetStopNameFromId(vertex), time);
+        }
+    }
+    return anser;
 }
     
 void RequestHandler::MakeRenderMap() {
@@ -84,6 +242,9 @@ void RequestHandler::RenderMap(std::ostream& out) const{
 }
 
 void RequestHandler::InitSerializationCatalog() {
+    // крупные части базы пишутся в файл по мере сериализации, а не собираются в памяти
+    serialization_.BeginSave();
+    
     // сериализуем остановки
     for(auto& stop_name : db_.GetAllStopName()) {
         auto coordinate = db_.GetStopCoordinate(stop_name);
@@ -91,43 +252,65 @@ void RequestHandler::InitSerializationCatalog() {
     }
     
     // сериализуем расстояния между остановками
-    std::vector<std::tuple<int, int, double>> distances = db_.GetDistances();
-    for (auto& distance : distances) {
-        serialization_.InitSerializationDistance(std::get<0>(distance),  std::get<1>(distance), std::get<2>(distance));
-    }
+    serialization_.InitSerializationDistances(db_.GetDistances());
     
     //  сериализуем маршруты
     for (auto& bus_name : db_.GetAllBusesName()) {
         const std::vector<int> bus_stops = db_.GetStopsNumToBus(bus_name);
-        serialization_.InitSerializationBus(std::string(bus_name), db_.IsRoundTrip(bus_name), bus_stops);
+        serialization_.InitSerializationBus(std::string(bus_name), db_.IsRoundTrip(bus_name), bus_stops, 
+                                            db_.GetBusTimetable(bus_name));
     }
     
+    // индекс "остановка -> маршруты" сохраняется, чтобы не строить его при обработке запросов
+    serialization_.InitStopBusIndex(db_.GetStopBusIndex());
+    
     // сериализация настройки пути
     auto router_settings = db_.GetRoutingSetting();
-    serialization_.InitRoutingSettings(router_settings.wait_time, router_settings.bus_velocity);
+    serialization_.InitRoutingSettings(router_settings);
 
     // сериализация графа
     {
-		const graph::DirectedWeightedGraph<double> graph = db_.GetGraph();
-		std::vector<domain::ForSerializationGraph> graphs_struct;
-		std::vector<std::vector<int>> incidence_lists(graph.GetVertexCount());
-		int size = graph.GetEdgeCount();
-		for (int i = 0; i < size; ++i) {
-			auto edge = graph.GetEdge(i);
-			domain::ForSerializationGraph conver_edge;
+		const graph::DirectedWeightedGraph<double>& graph = db_.GetGraph();
+		const size_t edge_count = graph.GetEdgeCount();
+		domain::ForSerializationGraph conver_edge;
+		for (size_t i = 0; i < edge_count; ++i) {
+			const auto edge = graph.GetEdge(i);
 			conver_edge.from = edge.from;
 			conver_edge.to = edge.to;
 			conver_edge.weight = edge.weight;
 			conver_edge.stops_count = edge.stops_count;
-			conver_edge.bus_name = edge.bus->bus;
+			if (edge.bus != nullptr) {
+				conver_edge.bus_name = edge.bus->bus;
+			} else {
+				conver_edge.bus_name.clear();
+			}
 			
-			graphs_struct.push_back(conver_edge);
-			incidence_lists.at(conver_edge.from).push_back(graphs_struct.size() - 1);
+			serialization_.InitGraphEdge(conver_edge);
 		}
 		
-		serialization_.InitGraph(graphs_struct, incidence_lists);
+		const size_t vertex_count = graph.GetVertexCount();
+		for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+			serialization_.InitIncidenceList(graph.GetIncidentEdges(vertex));
+		}
 	}
 	
+    // сериализация таблицы путей, чтобы не пересчитывать ее при обработке запросов
+    if (auto routes_internal_data = transport_router_.GetRoutesInternalData()) {
+        serialization_.InitRouterData(*routes_internal_data);
+    }
+    if (auto routes_table = transport_router_.GetRoutesTable()) {
+        serialization_.InitRouterData(*routes_table);
+    }
+    if (auto compact_routes_table = transport_router_.GetCompactRoutesTable()) {
+        serialization_.InitRouterData(*compact_routes_table);
+    }
+    if (auto hierarchy = transport_router_.GetHierarchyData()) {
+        serialization_.InitContractionHierarchy(*hierarchy);
+    }
+    if (auto landmarks = transport_router_.GetLandmarkData()) {
+        serialization_.InitLandmarks(*landmarks);
+    }
+	
     // сериализация настроек 
     {
         auto renderer_settings = renderer_.GetSettings();
@@ -157,49 +340,6 @@ void RequestHandler::SaveSerializationCatalog() {
 	serialization_.SaveTo();
 }
 
-void RequestHandler::DeserializeCatalogue() {
-    DeserializeStop();
-
-    DeserializeMapDistance();
-
-    DeserializeBus();
-    
-    DeserializeRenderMap();
-    
-}
-
-void RequestHandler::DeserializeStop() {
-    int stop_count = serialization_.GetStopCount();
-    for (int i = 0; i < stop_count; ++i) {
-        std::tuple<std::string, double, double> stop_data = serialization_.GetStopData(i); 
-        db_.AddStop(std::get<0>(stop_data), std::get<1>(stop_data), std::get<2>(stop_data));
-    }
-}
-
-void RequestHandler::DeserializeMapDistance() {
-    int map_size = serialization_.GetMapSize();
-    for (int i = 0; i < map_size; ++i) {
-        std::tuple<int, int, double> map_data = serialization_.GetMapData(i); 
-        auto stop_from = db_.FindStop(std::string(db_.GetStopNameFromId(std::get<0>(map_data))));
-        auto stop_to = db_.FindStop(std::string(db_.GetStopNameFromId(std::get<1>(map_data))));
-        db_.SetDistance(stop_from, stop_to,  std::get<2>(map_data));
-    }
-}
-
-void RequestHandler::DeserializeBus() {
-  int bus_count = serialization_.GetBusCount();
-  for (int i = 0; i < bus_count; ++i) {
-	std::string bus_name = serialization_.GetBusName(i);
-	bool round_trip = serialization_.GetRoundTripFlag(i);
-	std::vector<int> stops_id = serialization_.GetStopsId(i);
-	std::vector<std::string_view> stops;
-	for (auto id : stops_id) {
-	  stops.push_back(db_.GetStopNameFromId(id));
-	}
-	db_.AddBus(bus_name, stops, round_trip);
-  }
-}
-
 void RequestHandler::DeserializeRenderMap() {
   map_renderer::RenderSettings settings;
   settings.width = serialization_.GetRenderWidth();
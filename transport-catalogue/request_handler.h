@@ -12,16 +12,19 @@
 #pragma once
 
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <string>
 #include <string_view>
 #include <set>
+#include <optional>
 
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "domain.h"
 #include "graph.h"
 #include "transport_router.h"
+#include "connection_scan.h"
 #include "serialization.h"
 
 // #include "log_duration.h"
@@ -32,13 +35,47 @@ public:
 	serialization::Serialization& serialization) 
 		: db_(catalog)
 		, renderer_(renderer)
-		, transport_router_(graph)
+		, transport_router_(graph, catalog.GetRoutingSetting(), MakePrecomputedData(catalog, serialization))
+		, timetable_router_(catalog.GetBusesWithTimetable())
 		, serialization_(serialization)		
 	{
 	}
 
-	// Возвращаем информацию о пути
+	// Возвращаем информацию о пути (std::nullopt - пути нет или остановка не найдена)
 	const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> GetRouter(const std::string_view& stop_from, const std::string_view& stop_to) const;
+	
+	// Возвращаем информацию о пути по номерам остановок (FindStopId)
+	const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> GetRouter(size_t stop_from, size_t stop_to) const;
+	
+	// Возвращаем информацию о пути по расписанию с отправлением в departure_time (мин. от начала суток)
+	const std::optional<std::tuple<double, std::vector<domain::RouteInfo>>> GetRouter(const std::string_view& stop_from, const std::string_view& stop_to, 
+	                                                                                  int departure_time) const;
+	
+	// Возвращаем Парето-оптимальные пути по времени и числу пересадок (по возрастанию числа пересадок),
+	// пустой список - пути нет или остановка не найдена
+	std::vector<std::tuple<double, std::vector<domain::RouteInfo>>> GetRouteAlternatives(const std::string_view& stop_from, 
+	                                                                                    const std::string_view& stop_to) const;
+	
+	// Возвращаем номер остановки по ее названию (std::nullopt - остановка не найдена)
+	std::optional<size_t> FindStopId(const std::string_view& stop_name) const;
+	
+	// Возвращаем время в пути между всеми парами остановок stops_from x stops_to (std::nullopt в ячейке - пути нет,
+	// std::nullopt вместо матрицы - одна из остановок не найдена)
+	std::optional<std::vector<std::vector<std::optional<double>>>> GetRouteMatrix(const std::vector<std::string_view>& stops_from, 
+	                                                                              const std::vector<std::string_view>& stops_to) const;
+    
+    // Может ли выбранный движок маршрутов учесть изменение расстояний и настроек без make_base
+    bool CanUpdateRouter() const;
+    
+	// Возвращаем остановки, до которых можно доехать не дольше max_time, и время в пути до них (по возрастанию времени),
+	// std::nullopt - остановка не найдена или max_time отрицательно
+	std::optional<std::vector<std::pair<std::string_view, double>>> GetIsochrone(const std::string_view& stop_from, double max_time) const;
+    
+    // Изменяет расстояние между остановками, возвращает количество ребер графа с измененным весом
+    size_t UpdateDistance(const std::string_view& stop_from, const std::string_view& stop_to, double distance);
+    
+    // Изменяет время ожидания и скорость автобуса, возвращает количество ребер графа с измененным весом
+    size_t UpdateRoutingSetting(int wait_time, int bus_velocity);
     
     // Возвращает информацию о маршруте (запрос Bus)
     const std::optional<domain::BusStat> GetBusStat(const std::string_view& bus_name) const;
@@ -54,20 +91,26 @@ public:
     
     void SaveSerializationCatalog();
     
-    void DeserializeCatalogue();
-    
     void DeserializeRenderMap();
 private:
     catalog::TransportCatalogue& db_;
     map_renderer::MapRanderer& renderer_;
     transport_router::TransportRouter transport_router_;
-    serialization::Serialization serialization_;
+    connection_scan::ConnectionScanRouter timetable_router_;
+    serialization::Serialization& serialization_;
+    
+    /// Данные движка поиска маршрутов: сохраненные в базе и построенные по каталогу
+    static transport_router::PrecomputedData MakePrecomputedData(const catalog::TransportCatalogue& catalog, 
+                                                                 serialization::Serialization& serialization);
     
-    void DeserializeStop();
+    /// Данные движка поиска маршрутов, которые строятся по каталогу и не хранятся в базе
+    static transport_router::PrecomputedData MakeCatalogData(const catalog::TransportCatalogue& catalog);
     
-    void DeserializeMapDistance();
+    /// Передает изменения весов ребер в поиск маршрутов
+    size_t ApplyEdgeWeightChanges(const std::vector<graph::EdgeWeightChange<double>>& changes);
     
-    void DeserializeBus();
+    /// Переводит части пути из номеров остановок в названия, отделяя ожидание автобуса от поездки
+    std::vector<domain::RouteInfo> MakeRouteInfo(const std::vector<transport_router::RouteInfo>& vector_info) const;
     
 };
 
@@ -2,11 +2,15 @@
 
 #include "graph.h"
 
+#include "parallel.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -14,35 +18,205 @@
 
 namespace graph {
 
+/*!
+ * Поиск Дейкстры с бинарной кучей из вершины from по текущим весам графа
+ *
+ * @param weights, prev_edges длины путей и их последние ребра, размером с количество вершин, заполнены std::nullopt
+ * @param is_done вызывается для каждой вершины, до которой найден кратчайший путь;
+ * поиск прекращается, когда он вернет true
+ */
+template <typename Weight, typename IsDone>
+void SearchShortestPaths(const DirectedWeightedGraph<Weight>& graph, VertexId from, std::vector<std::optional<Weight>>& weights,
+                         std::vector<std::optional<EdgeId>>& prev_edges, IsDone is_done) {
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    weights[from] = Weight{};
+    queue.push({Weight{}, from});
+
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+
+        // в очереди могут остаться устаревшие записи о уже улучшенных вершинах
+        if (*weights[vertex] < weight) {
+            continue;
+        }
+        if (is_done(vertex)) {
+            break;
+        }
+
+        auto relax = [&, weight = weight](EdgeId edge_id, VertexId target, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            auto& target_weight = weights[target];
+            if (!target_weight || candidate_weight < *target_weight) {
+                target_weight = candidate_weight;
+                prev_edges[target] = edge_id;
+                queue.push({candidate_weight, target});
+            }
+        };
+
+        if (graph.IsFrozen()) {
+            // в замороженном графе вершины и веса дуг лежат в непрерывных массивах
+            const size_t arc_end = graph.GetArcEnd(vertex);
+            for (size_t arc = graph.GetArcBegin(vertex); arc < arc_end; ++arc) {
+                relax(graph.GetArcEdge(arc), graph.GetArcTarget(arc), graph.GetArcWeight(arc));
+            }
+        } else {
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                relax(edge_id, graph.GetEdgeTo(edge_id), graph.GetEdgeWeight(edge_id));
+            }
+        }
+    }
+}
+
+/*!
+ * Строки таблицы путей, которые испортило увеличение весов ребер
+ *
+ * Путь строки from, восстановленный по последним ребрам, проходит через ребро u -> v
+ * только если последнее ребро пути from -> v - это само ребро. Ребра таблицы без пути
+ * или с путем без ребер передаются как std::nullopt
+ *
+ * @param get_prev_edge(from, to) последнее ребро пути from -> to в таблице
+ * @return признак для каждой строки
+ */
+template <typename Weight, typename GetPrevEdge>
+std::vector<bool> FindRowsWithIncreasedEdges(const DirectedWeightedGraph<Weight>& graph, 
+                                             const std::vector<EdgeWeightChange<Weight>>& changes, GetPrevEdge get_prev_edge) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<bool> is_increased(graph.GetEdgeCount(), false);
+    std::vector<bool> is_target(vertex_count, false);
+    std::vector<VertexId> targets;
+    for (const auto& change : changes) {
+        const auto edge = graph.GetEdge(change.edge_id);
+        if (edge.weight > change.old_weight) {
+            is_increased[change.edge_id] = true;
+            if (!is_target[edge.to]) {
+                is_target[edge.to] = true;
+                targets.push_back(edge.to);
+            }
+        }
+    }
+
+    std::vector<bool> is_stale(vertex_count, false);
+    if (targets.empty()) {
+        return is_stale;
+    }
+    for (VertexId from = 0; from < vertex_count; ++from) {
+        for (const VertexId to : targets) {
+            const std::optional<EdgeId> prev_edge = get_prev_edge(from, to);
+            if (prev_edge && is_increased[*prev_edge]) {
+                is_stale[from] = true;
+                break;
+            }
+        }
+    }
+    return is_stale;
+}
+
+/// Общий интерфейс движков поиска кратчайших путей в графе
 template <typename Weight>
-class Router {
-private:
+class BaseRouter {
+protected:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    virtual ~BaseRouter() = default;
+
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
 
-    const Graph GetGraph() const;
+    /*!
+     * Веса кратчайших путей из from во все вершины to (без восстановления ребер пути)
+     *
+     * По умолчанию строит каждый маршрут отдельно, движки переопределяют метод,
+     * если могут найти веса для многих вершин быстрее
+     *
+     * @return веса путей в порядке вершин to, std::nullopt - пути нет
+     */
+    virtual std::vector<std::optional<Weight>> BuildRouteWeights(VertexId from, const std::vector<VertexId>& to) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(to.size());
+        for (const VertexId vertex_to : to) {
+            if (auto route = BuildRoute(from, vertex_to)) {
+                weights.push_back(route->weight);
+            } else {
+                weights.push_back(std::nullopt);
+            }
+        }
+        return weights;
+    }
+
+    /// Может ли движок учесть изменение весов ребер без построения заново
+    virtual bool CanUpdateEdgeWeights() const {
+        return false;
+    }
+
+    /*!
+     * Учитывает уже внесенные в граф изменения весов ребер
+     *
+     * По умолчанию заранее посчитанные данные не обновляются по частям
+     *
+     * @return false - данные движка устарели и его нужно построить заново
+     */
+    virtual bool UpdateEdgeWeights(const std::vector<EdgeWeightChange<Weight>>& changes) {
+        return changes.empty();
+    }
+
+    /// Граф, по которому строятся маршруты (без копирования)
+    virtual const Graph& GetGraph() const = 0;
+};
+
+/// Поиск путей по заранее посчитанной таблице всех пар вершин (Флойд-Уоршелл)
+template <typename Weight>
+class Router : public BaseRouter<Weight> {
 private:
+    using Graph = typename BaseRouter<Weight>::Graph;
+
+public:
+    using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
     struct RouteInternalData {
         Weight weight;
         std::optional<EdgeId> prev_edge;
     };
     using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
+    explicit Router(const Graph& graph);
+
+    /// Конструктор от заранее посчитанной таблицы путей (например, загруженной из базы)
+    Router(const Graph& graph, RoutesInternalData routes_internal_data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<Weight>> BuildRouteWeights(VertexId from, const std::vector<VertexId>& to) const override;
+
+    bool CanUpdateEdgeWeights() const override {
+        return true;
+    }
+
+    /*!
+     * Уменьшение весов учитывается за O(V^2) на ребро, при увеличении заново (поиском Дейкстры)
+     * считаются только строки, пути которых проходят через увеличенные ребра
+     */
+    bool UpdateEdgeWeights(const std::vector<EdgeWeightChange<Weight>>& changes) override;
+
+    const Graph& GetGraph() const override;
+
+    /// Таблица кратчайших путей между всеми парами вершин
+    const RoutesInternalData& GetRoutesInternalData() const;
+private:
+
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
             routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
+                const auto edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
@@ -96,10 +270,100 @@ Router<Weight>::Router(const Graph& graph)
 }
 
 template <typename Weight>
-const typename Router<Weight>::Graph Router<Weight>::GetGraph() const {
+Router<Weight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph)
+    , routes_internal_data_(std::move(routes_internal_data))
+{
+    if (routes_internal_data_.size() != graph.GetVertexCount()) {
+        throw std::invalid_argument("Routes internal data doesn't match the graph");
+    }
+}
+
+template <typename Weight>
+bool Router<Weight>::UpdateEdgeWeights(const std::vector<EdgeWeightChange<Weight>>& changes) {
+    const size_t vertex_count = routes_internal_data_.size();
+    
+    // строки с путями через увеличенные ребра считаются по измененному графу, остальные строки
+    // остаются кратчайшими: их пути не подорожали, а другие пути подешеветь не могли
+    const std::vector<bool> is_stale = FindRowsWithIncreasedEdges(graph_, changes, [this](VertexId from, VertexId to) {
+        const auto& route = routes_internal_data_[from][to];
+        return route ? route->prev_edge : std::nullopt;
+    });
+    parallel::ForEachRange(vertex_count, [&](size_t, size_t begin, size_t end) {
+        std::vector<std::optional<Weight>> weights(vertex_count);
+        std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+        for (VertexId from = begin; from < end; ++from) {
+            if (!is_stale[from]) {
+                continue;
+            }
+            std::fill(weights.begin(), weights.end(), std::nullopt);
+            std::fill(prev_edges.begin(), prev_edges.end(), std::nullopt);
+            SearchShortestPaths(graph_, from, weights, prev_edges, [](VertexId) {
+                return false;
+            });
+            auto& routes = routes_internal_data_[from];
+            for (VertexId to = 0; to < vertex_count; ++to) {
+                routes[to] = weights[to] ? std::optional<RouteInternalData>(RouteInternalData{*weights[to], prev_edges[to]}) : std::nullopt;
+            }
+        }
+    });
+
+    // путь a -> b через уменьшенное ребро u -> v: a -> u, ребро, v -> b. Столбец u и строка v
+    // при этом не меняются (веса неотрицательны), поэтому таблицу можно обновлять на месте
+    for (const auto& change : changes) {
+        const auto edge = graph_.GetEdge(change.edge_id);
+        if (!(edge.weight < change.old_weight)) {
+            continue;
+        }
+        const auto& routes_from_edge = routes_internal_data_[edge.to];
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            const auto& route_to_edge = routes_internal_data_[vertex_from][edge.from];
+            if (!route_to_edge) {
+                continue;
+            }
+            const Weight weight_to_edge = route_to_edge->weight + edge.weight;
+            auto& routes = routes_internal_data_[vertex_from];
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                const auto& route_from_edge = routes_from_edge[vertex_to];
+                if (!route_from_edge) {
+                    continue;
+                }
+                const Weight candidate_weight = weight_to_edge + route_from_edge->weight;
+                if (!routes[vertex_to] || candidate_weight < routes[vertex_to]->weight) {
+                    routes[vertex_to] = RouteInternalData{candidate_weight,
+                        route_from_edge->prev_edge ? route_from_edge->prev_edge : std::optional<EdgeId>(change.edge_id)};
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Weight>
+const typename Router<Weight>::Graph& Router<Weight>::GetGraph() const {
     return graph_;
 }
 
+template <typename Weight>
+const typename Router<Weight>::RoutesInternalData& Router<Weight>::GetRoutesInternalData() const {
+    return routes_internal_data_;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> Router<Weight>::BuildRouteWeights(VertexId from, const std::vector<VertexId>& to) const {
+    const auto& row = routes_internal_data_.at(from);
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(to.size());
+    for (const VertexId vertex_to : to) {
+        if (const auto& route_internal_data = row.at(vertex_to)) {
+            weights.push_back(route_internal_data->weight);
+        } else {
+            weights.push_back(std::nullopt);
+        }
+    }
+    return weights;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
@@ -111,7 +375,7 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     std::vector<EdgeId> edges;
     for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
          edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+         edge_id = routes_internal_data_[from][graph_.GetEdgeFrom(*edge_id)]->prev_edge)
     {
         edges.push_back(*edge_id);
     }
@@ -1,11 +1,133 @@
 #include "serialization.h"
 
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+
+#include <google/protobuf/wire_format_lite.h>
+
 using namespace serialization;
 
+namespace {
+
+std::string GetTempFile(const std::string& file) {
+  return file + ".tmp";
+}
+
+/// Заменяет базу file записанным временным файлом (переименование в пределах каталога атомарно)
+void ReplaceBase(const std::string& file) {
+  if (std::rename(GetTempFile(file).c_str(), file.c_str()) != 0) {
+	std::remove(GetTempFile(file).c_str());
+	throw std::runtime_error("Can't replace base " + file);
+  }
+}
+
+}  // namespace
+
 void Serialization::SetFilePath(std::string file_path) {
   file_ = std::move(file_path);
 }
 
+void Serialization::SetFormat(BaseFormat format) {
+  format_ = format;
+}
+
+void Serialization::BeginSave() {
+  if (format_ != BaseFormat::PROTOBUF) {
+	return;
+  }
+  out_file_ = std::make_unique<std::ofstream>(GetTempFile(file_), std::ios::binary);
+  if (!*out_file_) {
+	throw std::runtime_error("Can't open base " + file_);
+  }
+  raw_output_ = std::make_unique<google::protobuf::io::OstreamOutputStream>(out_file_.get());
+  output_ = std::make_unique<google::protobuf::io::CodedOutputStream>(raw_output_.get());
+}
+
+// Повторяющееся поле сообщения protobuf можно записывать по одному элементу в любом месте,
+// поэтому запись полей по мере добавления дает файл, который читается как обычный catalog_buf::Catalog
+void Serialization::WriteCatalogField(int field_number, const google::protobuf::MessageLite& message) {
+  using google::protobuf::internal::WireFormatLite;
+  const size_t size = message.ByteSizeLong();
+  output_->WriteTag(WireFormatLite::MakeTag(field_number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+  output_->WriteVarint32(static_cast<std::uint32_t>(size));
+  message.SerializeWithCachedSizes(output_.get());
+}
+
+// Одиночное поле-сообщение, встреченное несколько раз, при разборе сливается, поэтому граф пишется
+// частями по GRAPH_CHUNK_SIZE ребер и списков ребер
+void Serialization::FlushGraphChunk() {
+  if (graph_chunk_.edges_size() == 0 && graph_chunk_.incidence_lists_size() == 0) {
+	return;
+  }
+  WriteCatalogField(catalog_buf::Catalog::kGraphFieldNumber, graph_chunk_);
+  graph_chunk_.Clear();
+}
+
+// Повторяющиеся числа в proto3 упакованы: поле - тег, длина в байтах и значения подряд,
+// поэтому размер сообщения считается заранее, а значения пишутся построчно.
+// Размер весов известен из числа ячеек, а последние ребра - varint переменной длины, и длина поля
+// пишется до его значений, поэтому по ним делается отдельный проход: он лишь читает номера ребер
+// и дешевле, чем держать закодированную таблицу в памяти
+template <typename StoredWeight, typename GetWeight, typename GetPrevEdge>
+void Serialization::WriteRouterData(size_t vertex_count, GetWeight get_weight, GetPrevEdge get_prev_edge) {
+  using google::protobuf::internal::WireFormatLite;
+  static_assert(std::is_same_v<StoredWeight, double> || std::is_same_v<StoredWeight, float>, "Weights are stored as double or float");
+  
+  const int weight_field = std::is_same_v<StoredWeight, double> ? catalog_buf::RouterData::kWeightFieldNumber 
+                                                                 : catalog_buf::RouterData::kCompactWeightFieldNumber;
+  const size_t weights_size = vertex_count * vertex_count * sizeof(StoredWeight);
+  size_t prev_edges_size = 0;
+  for (size_t from = 0; from < vertex_count; ++from) {
+	for (size_t to = 0; to < vertex_count; ++to) {
+	  prev_edges_size += WireFormatLite::Int32Size(get_prev_edge(from, to));
+	}
+  }
+  
+  auto packed_field_size = [](int field_number, size_t data_size) -> size_t {
+	return data_size == 0 ? 0 : WireFormatLite::TagSize(field_number, WireFormatLite::TYPE_BYTES) 
+	                            + WireFormatLite::LengthDelimitedSize(data_size);
+  };
+  auto write_packed_field_header = [this](int field_number, size_t data_size) {
+	output_->WriteTag(WireFormatLite::MakeTag(field_number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+	output_->WriteVarint32(static_cast<std::uint32_t>(data_size));
+  };
+  
+  const int vertex_count_value = static_cast<int>(vertex_count);
+  const size_t message_size = (vertex_count == 0 ? 0 : WireFormatLite::TagSize(catalog_buf::RouterData::kVertexCountFieldNumber, 
+                                                                                 WireFormatLite::TYPE_INT32)
+                                                       + WireFormatLite::Int32Size(vertex_count_value))
+                              + packed_field_size(weight_field, weights_size)
+                              + packed_field_size(catalog_buf::RouterData::kPrevEdgeFieldNumber, prev_edges_size);
+  output_->WriteTag(WireFormatLite::MakeTag(catalog_buf::Catalog::kRouterDataFieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+  output_->WriteVarint32(static_cast<std::uint32_t>(message_size));
+  if (vertex_count == 0) {
+	return;
+  }
+  WireFormatLite::WriteInt32(catalog_buf::RouterData::kVertexCountFieldNumber, vertex_count_value, output_.get());
+  
+  write_packed_field_header(weight_field, weights_size);
+  std::vector<StoredWeight> row(vertex_count);
+  for (size_t from = 0; from < vertex_count; ++from) {
+	for (size_t to = 0; to < vertex_count; ++to) {
+	  row[to] = get_weight(from, to);
+	}
+	if constexpr (std::is_same_v<StoredWeight, double>) {
+	  WireFormatLite::WriteDoubleArray(row.data(), static_cast<int>(vertex_count), output_.get());
+	} else {
+	  WireFormatLite::WriteFloatArray(row.data(), static_cast<int>(vertex_count), output_.get());
+	}
+  }
+  
+  write_packed_field_header(catalog_buf::RouterData::kPrevEdgeFieldNumber, prev_edges_size);
+  for (size_t from = 0; from < vertex_count; ++from) {
+	for (size_t to = 0; to < vertex_count; ++to) {
+	  WireFormatLite::WriteInt32NoTag(get_prev_edge(from, to), output_.get());
+	}
+  }
+}
+
 void Serialization::InitSerializationStop(std::string stop_name,  double lat, double lng) {
     catalog_buf::Stop stop_pb;
     stop_pb.set_stop_name(stop_name);
@@ -14,22 +136,40 @@ void Serialization::InitSerializationStop(std::string stop_name,  double lat, do
     coordinate_pb.set_lng(lng);
     *stop_pb.mutable_point() = std::move(coordinate_pb);
     
-    serialization_catalog_.add_stop();
-    *serialization_catalog_.mutable_stop(serialization_catalog_.stop_size()-1) = std::move(stop_pb);
+    if (output_) {
+        WriteCatalogField(catalog_buf::Catalog::kStopFieldNumber, stop_pb);
+        return;
+    }
+    *serialization_catalog_.add_stop() = std::move(stop_pb);
 }
 
 
 void Serialization::InitSerializationDistance(int stop_id_from, int stop_id_to,  double distance) {
-    catalog_buf::Distance distance_pb;
-    distance_pb.set_stop_id_from(stop_id_from);
-    distance_pb.set_stop_id_to(stop_id_to);
-    distance_pb.set_distance(distance);
-    
-    serialization_catalog_.add_map_distance();
-    *serialization_catalog_.mutable_map_distance(serialization_catalog_.map_distance_size()-1) = std::move(distance_pb);
+    if (output_) {
+        catalog_buf::Distance distance_pb;
+        distance_pb.set_stop_id_from(stop_id_from);
+        distance_pb.set_stop_id_to(stop_id_to);
+        distance_pb.set_distance(distance);
+        WriteCatalogField(catalog_buf::Catalog::kMapDistanceFieldNumber, distance_pb);
+        return;
+    }
+    catalog_buf::Distance* distance_pb = serialization_catalog_.add_map_distance();
+    distance_pb->set_stop_id_from(stop_id_from);
+    distance_pb->set_stop_id_to(stop_id_to);
+    distance_pb->set_distance(distance);
 }
 
-void Serialization::InitSerializationBus(std::string bus_name, bool round_trip, std::vector<int> bus_stops) {
+void Serialization::InitSerializationDistances(const std::vector<std::tuple<int, int, double>>& distances) {
+    if (!output_) {
+        serialization_catalog_.mutable_map_distance()->Reserve(serialization_catalog_.map_distance_size() + static_cast<int>(distances.size()));
+    }
+    for (const auto& [stop_id_from, stop_id_to, distance] : distances) {
+        InitSerializationDistance(stop_id_from, stop_id_to, distance);
+    }
+}
+
+void Serialization::InitSerializationBus(std::string bus_name, bool round_trip, std::vector<int> bus_stops, 
+                                         const std::vector<int>& timetable) {
     catalog_buf::Bus bus_pb;
     bus_pb.set_bus_name(bus_name);
     bus_pb.set_round_trip(round_trip);
@@ -38,47 +178,262 @@ void Serialization::InitSerializationBus(std::string bus_name, bool round_trip,
         bus_pb.add_stop_num(stop_num);
     }
     
-    serialization_catalog_.add_bus();
-    *serialization_catalog_.mutable_bus(serialization_catalog_.bus_size()-1) = std::move(bus_pb);
+    // соседние отправления близки, разности занимают в zigzag-кодировке 1-2 байта
+    int prev_departure = 0;
+    for (int departure : timetable) {
+        bus_pb.add_timetable(departure - prev_departure);
+        prev_departure = departure;
+    }
+    
+    if (output_) {
+        WriteCatalogField(catalog_buf::Catalog::kBusFieldNumber, bus_pb);
+        return;
+    }
+    *serialization_catalog_.add_bus() = std::move(bus_pb);
 }
 
-void Serialization::InitRoutingSettings(int wait_time,  int bus_velocity) {
+void Serialization::InitRoutingSettings(const domain::RoutingSetting& routing_setting) {
     catalog_buf::RoutingSetting settings_pb;
-    settings_pb.set_wait_time(wait_time);
-    settings_pb.set_bus_velocity(bus_velocity);
+    settings_pb.set_wait_time(routing_setting.wait_time);
+    settings_pb.set_bus_velocity(routing_setting.bus_velocity);
+    settings_pb.set_router_type(static_cast<catalog_buf::RouterType>(routing_setting.router_type));
+    settings_pb.set_graph_model(static_cast<catalog_buf::GraphModel>(routing_setting.graph_model));
+    settings_pb.set_route_table_precision(static_cast<catalog_buf::RouteTablePrecision>(routing_setting.route_table_precision));
+    settings_pb.set_landmark_count(routing_setting.landmark_count);
+    settings_pb.set_route_criterion(static_cast<catalog_buf::RouteCriterion>(routing_setting.route_criterion));
     
     *serialization_catalog_.mutable_routing_setting() = std::move(settings_pb);
 }
 
-void Serialization::InitGraph(std::vector<domain::ForSerializationGraph> edges, std::vector<std::vector<int>> edge_id) {
-	catalog_buf::Graph graph_pb;
+void Serialization::InitStopBusIndex(const domain::StopBusIndex& stop_bus_index) {
+    catalog_buf::StopBusIndex index_pb;
+    index_pb.mutable_offsets()->Add(stop_bus_index.offsets.begin(), stop_bus_index.offsets.end());
+    index_pb.mutable_bus_ids()->Add(stop_bus_index.bus_ids.begin(), stop_bus_index.bus_ids.end());
+    
+    if (output_) {
+        WriteCatalogField(catalog_buf::Catalog::kStopBusIndexFieldNumber, index_pb);
+        return;
+    }
+    *serialization_catalog_.mutable_stop_bus_index() = std::move(index_pb);
+}
+
+void Serialization::InitGraphEdge(const domain::ForSerializationGraph& edge) {
+	catalog_buf::Edge edge_pb;
+	edge_pb.set_from(edge.from);
+	edge_pb.set_to(edge.to);
+	edge_pb.set_weight(edge.weight);
+	edge_pb.set_stops_count(edge.stops_count);
+	edge_pb.set_bus_name(edge.bus_name);
 	
-	for (auto& edge : edges) {
-		catalog_buf::Edge edge_pb;
+	if (output_) {
+		*graph_chunk_.add_edges() = std::move(edge_pb);
+		if (graph_chunk_.edges_size() + graph_chunk_.incidence_lists_size() >= GRAPH_CHUNK_SIZE) {
+			FlushGraphChunk();
+		}
+		return;
+	}
+	*serialization_catalog_.mutable_graph()->add_edges() = std::move(edge_pb);
+}
+
+void Serialization::InitIncidenceList(graph::DirectedWeightedGraph<double>::IncidentEdgesRange edge_ids) {
+	catalog_buf::IncidenceList edges_id_pb;
+	for (auto id : edge_ids) {
+		edges_id_pb.add_edge_id(static_cast<int>(id));
+	}
 	
-		edge_pb.set_from(edge.from);
-		edge_pb.set_to(edge.to);
-		edge_pb.set_weight(edge.weight);
-		edge_pb.set_stops_count(edge.stops_count);
-		edge_pb.set_bus_name(edge.bus_name);
-		
-		graph_pb.add_edges();
-		*graph_pb.mutable_edges(graph_pb.edges_size() - 1) = std::move(edge_pb);
+	if (output_) {
+		*graph_chunk_.add_incidence_lists() = std::move(edges_id_pb);
+		if (graph_chunk_.edges_size() + graph_chunk_.incidence_lists_size() >= GRAPH_CHUNK_SIZE) {
+			FlushGraphChunk();
+		}
+		return;
+	}
+	*serialization_catalog_.mutable_graph()->add_incidence_lists() = std::move(edges_id_pb);
+}
+
+void Serialization::InitRouterData(const graph::Router<double>::RoutesInternalData& routes_internal_data) {
+	const size_t vertex_count = routes_internal_data.size();
+	if (format_ == BaseFormat::FLAT) {
+		flat_route_weights_.assign(vertex_count * vertex_count, std::numeric_limits<double>::infinity());
+		flat_route_prev_edges_.assign(vertex_count * vertex_count, graph::RoutesTable<double>::NO_EDGE);
+		for (size_t from = 0; from < vertex_count; ++from) {
+			for (size_t to = 0; to < vertex_count; ++to) {
+				if (const auto& cell = routes_internal_data[from][to]) {
+					flat_route_weights_[from * vertex_count + to] = cell->weight;
+					if (cell->prev_edge) {
+						flat_route_prev_edges_[from * vertex_count + to] = static_cast<std::uint32_t>(*cell->prev_edge);
+					}
+				}
+			}
+		}
+		return;
+	}
+	if (output_) {
+		WriteRouterData<double>(vertex_count, 
+			[&routes_internal_data](size_t from, size_t to) {
+				const auto& cell = routes_internal_data[from][to];
+				return cell ? cell->weight : std::numeric_limits<double>::infinity();
+			},
+			[&routes_internal_data](size_t from, size_t to) {
+				const auto& cell = routes_internal_data[from][to];
+				return cell && cell->prev_edge ? static_cast<int>(*cell->prev_edge) : -1;
+			});
+		return;
 	}
 	
-	for (auto& list : edge_id) {
-		
-		catalog_buf::IncidenceList edges_id_pb;
-		
-		for (auto& id : list) {
-			edges_id_pb.add_edge_id(id);
+	catalog_buf::RouterData router_data_pb;
+	router_data_pb.set_vertex_count(static_cast<int>(vertex_count));
+	router_data_pb.mutable_weight()->Reserve(vertex_count * vertex_count);
+	router_data_pb.mutable_prev_edge()->Reserve(vertex_count * vertex_count);
+	
+	for (auto& row : routes_internal_data) {
+		for (auto& cell : row) {
+			if (!cell) {
+				router_data_pb.add_weight(std::numeric_limits<double>::infinity());
+				router_data_pb.add_prev_edge(-1);
+			} else {
+				router_data_pb.add_weight(cell->weight);
+				router_data_pb.add_prev_edge(cell->prev_edge ? static_cast<int>(*cell->prev_edge) : -1);
+			}
 		}
-		
-		graph_pb.add_incidence_lists();
-		*graph_pb.mutable_incidence_lists(graph_pb.incidence_lists_size() - 1) = std::move(edges_id_pb);
 	}
 	
-	*serialization_catalog_.mutable_graph() = std::move(graph_pb);
+	*serialization_catalog_.mutable_router_data() = std::move(router_data_pb);
+}
+
+namespace {
+
+/// Записывает в router_data_pb размер и последние ребра плоской таблицы путей (веса пишет вызывающий)
+template <typename StoredWeight>
+void InitRoutesTablePrevEdges(catalog_buf::RouterData& router_data_pb, const graph::RoutesTable<StoredWeight>& routes_table) {
+	router_data_pb.set_vertex_count(static_cast<int>(routes_table.vertex_count));
+	router_data_pb.mutable_prev_edge()->Reserve(routes_table.prev_edges.size());
+	for (auto prev_edge : routes_table.prev_edges) {
+		router_data_pb.add_prev_edge(prev_edge == graph::RoutesTable<StoredWeight>::NO_EDGE ? -1 : static_cast<int>(prev_edge));
+	}
+}
+
+/// Последнее ребро (-1 - нет) ячейки плоской таблицы путей для записи в поле router_data
+template <typename StoredWeight>
+int GetRoutesTablePrevEdge(const graph::RoutesTable<StoredWeight>& routes_table, size_t from, size_t to) {
+	const auto prev_edge = routes_table.prev_edges[from * routes_table.vertex_count + to];
+	return prev_edge == graph::RoutesTable<StoredWeight>::NO_EDGE ? -1 : static_cast<int>(prev_edge);
+}
+
+/// Проверяет, что в массиве таблицы путей ровно vertex_count^2 ячеек
+void CheckRoutesTableSize(size_t vertex_count, size_t size, const std::string& what) {
+	if (size != vertex_count * vertex_count) {
+		throw std::runtime_error("Router data " + what + " has " + std::to_string(size) + " cells, expected "
+		                         + std::to_string(vertex_count) + "^2");
+	}
+}
+
+/// Заполняет размер и последние ребра плоской таблицы путей из router_data_pb (веса заполняет вызывающий)
+template <typename StoredWeight>
+void ExtractRoutesTablePrevEdges(const catalog_buf::RouterData& router_data_pb, graph::RoutesTable<StoredWeight>& routes_table) {
+	using PrevEdge = typename graph::RoutesTable<StoredWeight>::PrevEdge;
+	
+	routes_table.vertex_count = static_cast<size_t>(router_data_pb.vertex_count());
+	CheckRoutesTableSize(routes_table.vertex_count, router_data_pb.prev_edge_size(), "prev_edge");
+	routes_table.prev_edges.reserve(router_data_pb.prev_edge_size());
+	for (auto prev_edge : router_data_pb.prev_edge()) {
+		routes_table.prev_edges.push_back(prev_edge < 0 ? graph::RoutesTable<StoredWeight>::NO_EDGE 
+		                                                : static_cast<PrevEdge>(prev_edge));
+	}
+}
+
+}  // namespace
+
+void Serialization::InitRouterData(const graph::RoutesTable<double>& routes_table) {
+	if (format_ == BaseFormat::FLAT) {
+		flat_route_weights_ = routes_table.weights;
+		flat_route_prev_edges_ = routes_table.prev_edges;
+		return;
+	}
+	if (output_) {
+		WriteRouterData<double>(routes_table.vertex_count, 
+			[&routes_table](size_t from, size_t to) {
+				return routes_table.weights[from * routes_table.vertex_count + to];
+			},
+			[&routes_table](size_t from, size_t to) {
+				return GetRoutesTablePrevEdge(routes_table, from, to);
+			});
+		return;
+	}
+	
+	catalog_buf::RouterData router_data_pb;
+	
+	router_data_pb.mutable_weight()->Add(routes_table.weights.begin(), routes_table.weights.end());
+	InitRoutesTablePrevEdges(router_data_pb, routes_table);
+	
+	*serialization_catalog_.mutable_router_data() = std::move(router_data_pb);
+}
+
+void Serialization::InitRouterData(const graph::RoutesTable<float>& routes_table) {
+	if (format_ == BaseFormat::FLAT) {
+		flat_route_compact_weights_ = routes_table.weights;
+		flat_route_prev_edges_ = routes_table.prev_edges;
+		return;
+	}
+	if (output_) {
+		WriteRouterData<float>(routes_table.vertex_count, 
+			[&routes_table](size_t from, size_t to) {
+				return routes_table.weights[from * routes_table.vertex_count + to];
+			},
+			[&routes_table](size_t from, size_t to) {
+				return GetRoutesTablePrevEdge(routes_table, from, to);
+			});
+		return;
+	}
+	
+	catalog_buf::RouterData router_data_pb;
+	
+	router_data_pb.mutable_compact_weight()->Add(routes_table.weights.begin(), routes_table.weights.end());
+	InitRoutesTablePrevEdges(router_data_pb, routes_table);
+	
+	*serialization_catalog_.mutable_router_data() = std::move(router_data_pb);
+}
+
+void Serialization::InitContractionHierarchy(const graph::ContractionHierarchyData<double>& hierarchy) {
+	catalog_buf::ContractionHierarchy hierarchy_pb;
+	
+	hierarchy_pb.mutable_rank()->Reserve(hierarchy.ranks.size());
+	for (auto rank : hierarchy.ranks) {
+		hierarchy_pb.add_rank(static_cast<int>(rank));
+	}
+	
+	for (auto& shortcut : hierarchy.shortcuts) {
+		catalog_buf::Shortcut* shortcut_pb = hierarchy_pb.add_shortcuts();
+		shortcut_pb->set_from(static_cast<int>(shortcut.from));
+		shortcut_pb->set_to(static_cast<int>(shortcut.to));
+		shortcut_pb->set_weight(shortcut.weight);
+		shortcut_pb->set_first_edge(static_cast<int>(shortcut.first));
+		shortcut_pb->set_second_edge(static_cast<int>(shortcut.second));
+	}
+	
+	if (output_) {
+		WriteCatalogField(catalog_buf::Catalog::kContractionHierarchyFieldNumber, hierarchy_pb);
+		return;
+	}
+	*serialization_catalog_.mutable_contraction_hierarchy() = std::move(hierarchy_pb);
+}
+
+void Serialization::InitLandmarks(const graph::LandmarkData<double>& landmarks) {
+	catalog_buf::Landmarks landmarks_pb;
+	
+	landmarks_pb.set_vertex_count(static_cast<int>(landmarks.vertex_count));
+	landmarks_pb.mutable_vertex()->Reserve(landmarks.landmarks.size());
+	for (auto vertex : landmarks.landmarks) {
+		landmarks_pb.add_vertex(static_cast<int>(vertex));
+	}
+	landmarks_pb.mutable_from_landmark()->Add(landmarks.from_landmarks.begin(), landmarks.from_landmarks.end());
+	landmarks_pb.mutable_to_landmark()->Add(landmarks.to_landmarks.begin(), landmarks.to_landmarks.end());
+	
+	if (output_) {
+		WriteCatalogField(catalog_buf::Catalog::kLandmarksFieldNumber, landmarks_pb);
+		return;
+	}
+	*serialization_catalog_.mutable_landmarks() = std::move(landmarks_pb);
 }
 
 void Serialization::InitRenderSettiingsParam(double width, double heidht, double padding, double line_width, double stop_radius, int bus_lable_font_size, int stop_lable_font_size, double underlayer_width) {
@@ -104,12 +459,9 @@ void Serialization::InitRenderPoint(double bus_x, double bus_y, double stop_x, d
     stop_point_pb.set_x(stop_x);
     stop_point_pb.set_y(stop_y);
     
-    catalog_buf::RenderSetting settings_pb = *serialization_catalog_.mutable_render_settings();
-    
+    catalog_buf::RenderSetting& settings_pb = *serialization_catalog_.mutable_render_settings();
     *settings_pb.mutable_bus_label_offset() = std::move(bus_point_pb);
     *settings_pb.mutable_stop_label_offset() = std::move(stop_point_pb);
-    
-    *serialization_catalog_.mutable_render_settings() = std::move(settings_pb);
 }
 
 catalog_buf::Color Serialization::ConvertColor(std::monostate) {
@@ -154,7 +506,7 @@ catalog_buf::Color Serialization::ConvertColor(svg::Rgba color) {
 }
 
 void Serialization::InitRenderColor(svg::Color underlayer_color, std::vector<svg::Color> color_palette) {
-    catalog_buf::RenderSetting settings_pb = *serialization_catalog_.mutable_render_settings();
+    catalog_buf::RenderSetting& settings_pb = *serialization_catalog_.mutable_render_settings();
     
     catalog_buf::Color underlayer_color_pb;
     std::visit([&] (auto&& value) { underlayer_color_pb = ConvertColor(value); }, underlayer_color);
@@ -163,11 +515,8 @@ void Serialization::InitRenderColor(svg::Color underlayer_color, std::vector<svg
     for (auto& color : color_palette) {
         catalog_buf::Color color_pb;
         std::visit([&] (auto&& value) { color_pb = ConvertColor(value); }, color);
-        settings_pb.add_color_palette();
-        *settings_pb.mutable_color_palette(settings_pb.color_palette_size() - 1) = std::move(color_pb);
+        *settings_pb.add_color_palette() = std::move(color_pb);
     }
-    
-    *serialization_catalog_.mutable_render_settings() = std::move(settings_pb);
 }
 
 // // Сериализует каталог
@@ -213,42 +562,238 @@ void Serialization::InitSerializationCatalog(const catalog::TransportCatalogue&
 }*/
 
 // Сохраняет сериализованный каталог в поток output
-void Serialization::SaveTo() const {
-	std::ofstream out_file(file_, std::ios::binary);
-    serialization_catalog_.SerializeToOstream(&out_file);
+void Serialization::SaveTo() {
+	if (format_ == BaseFormat::FLAT) {
+		SaveFlatBase();
+		return;
+	}
+	// при потоковой записи в файле уже все, кроме настроек и последней части графа
+	if (output_) {
+		FlushGraphChunk();
+		serialization_catalog_.SerializeToCodedStream(output_.get());
+		const bool failed = output_->HadError();
+		output_.reset();
+		raw_output_.reset();
+		out_file_->close();
+		const bool closed = static_cast<bool>(*out_file_);
+		out_file_.reset();
+		if (failed || !closed) {
+			std::remove(GetTempFile(file_).c_str());
+			throw std::runtime_error("Can't write base " + file_);
+		}
+		ReplaceBase(file_);
+		return;
+	}
+	{
+		std::ofstream out_file(GetTempFile(file_), std::ios::binary);
+		if (!serialization_catalog_.SerializeToOstream(&out_file)) {
+			std::remove(GetTempFile(file_).c_str());
+			throw std::runtime_error("Can't write base " + file_);
+		}
+	}
+	ReplaceBase(file_);
 }
 
+// Сохраняет каталог в плоском формате: остановки, расстояния, маршруты, индекс, граф и таблицу путей - массивами
+// записей, остальное (настройки, иерархия сжатия, ориентиры) - сообщением protobuf в секции PROTO
+void Serialization::SaveFlatBase() {
+	std::string strings;
+	
+	std::vector<flat_base::StopRecord> stops;
+	stops.reserve(serialization_catalog_.stop_size());
+	for (const auto& stop_pb : serialization_catalog_.stop()) {
+		stops.push_back({stop_pb.point().lat(), stop_pb.point().lng(),
+		                 static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(stop_pb.stop_name().size())});
+		strings += stop_pb.stop_name();
+	}
+	
+	std::vector<flat_base::DistanceRecord> distances;
+	distances.reserve(serialization_catalog_.map_distance_size());
+	for (const auto& distance_pb : serialization_catalog_.map_distance()) {
+		distances.push_back({static_cast<std::uint32_t>(distance_pb.stop_id_from()), static_cast<std::uint32_t>(distance_pb.stop_id_to()),
+		                     distance_pb.distance()});
+	}
+	
+	std::vector<flat_base::BusRecord> buses;
+	std::vector<std::uint32_t> bus_stops;
+	std::vector<std::int32_t> timetables;
+	std::unordered_map<std::string_view, std::uint32_t> bus_ids;
+	buses.reserve(serialization_catalog_.bus_size());
+	for (const auto& bus_pb : serialization_catalog_.bus()) {
+		bus_ids.emplace(bus_pb.bus_name(), static_cast<std::uint32_t>(buses.size()));
+		
+		flat_base::BusRecord bus{};
+		bus.name_offset = static_cast<std::uint32_t>(strings.size());
+		bus.name_size = static_cast<std::uint32_t>(bus_pb.bus_name().size());
+		bus.stops_begin = static_cast<std::uint32_t>(bus_stops.size());
+		bus.stop_count = static_cast<std::uint32_t>(bus_pb.stop_num_size());
+		bus.timetable_begin = static_cast<std::uint32_t>(timetables.size());
+		bus.timetable_size = static_cast<std::uint32_t>(bus_pb.timetable_size());
+		bus.round_trip = bus_pb.round_trip();
+		buses.push_back(bus);
+		
+		strings += bus_pb.bus_name();
+		bus_stops.insert(bus_stops.end(), bus_pb.stop_num().begin(), bus_pb.stop_num().end());
+		// в плоском формате расписание хранится без разностей, чтобы читать его на месте
+		int departure = 0;
+		for (int delta : bus_pb.timetable()) {
+			departure += delta;
+			timetables.push_back(departure);
+		}
+	}
+	
+	const std::vector<std::uint32_t> stop_bus_offsets(serialization_catalog_.stop_bus_index().offsets().begin(),
+	                                                  serialization_catalog_.stop_bus_index().offsets().end());
+	const std::vector<std::uint32_t> stop_bus_ids(serialization_catalog_.stop_bus_index().bus_ids().begin(),
+	                                              serialization_catalog_.stop_bus_index().bus_ids().end());
+	
+	std::vector<flat_base::EdgeRecord> edges;
+	edges.reserve(serialization_catalog_.graph().edges_size());
+	for (const auto& edge_pb : serialization_catalog_.graph().edges()) {
+		const std::uint32_t bus_id = edge_pb.bus_name().empty() ? flat_base::EdgeRecord::NO_BUS : bus_ids.at(edge_pb.bus_name());
+		edges.push_back({static_cast<std::uint32_t>(edge_pb.from()), static_cast<std::uint32_t>(edge_pb.to()), edge_pb.weight(),
+		                 static_cast<std::uint32_t>(edge_pb.stops_count()), bus_id});
+	}
+	
+	std::vector<std::uint32_t> incidence_offsets;
+	std::vector<std::uint32_t> incidence_edges;
+	incidence_offsets.reserve(serialization_catalog_.graph().incidence_lists_size() + 1);
+	incidence_edges.reserve(serialization_catalog_.graph().edges_size());
+	incidence_offsets.push_back(0);
+	for (const auto& list_pb : serialization_catalog_.graph().incidence_lists()) {
+		incidence_edges.insert(incidence_edges.end(), list_pb.edge_id().begin(), list_pb.edge_id().end());
+		incidence_offsets.push_back(static_cast<std::uint32_t>(incidence_edges.size()));
+	}
+	
+	// записанные массивами поля на время сериализации остатка убираются из сообщения
+	catalog_buf::Catalog bulky;
+	bulky.mutable_stop()->Swap(serialization_catalog_.mutable_stop());
+	bulky.mutable_bus()->Swap(serialization_catalog_.mutable_bus());
+	bulky.mutable_map_distance()->Swap(serialization_catalog_.mutable_map_distance());
+	bulky.mutable_graph()->Swap(serialization_catalog_.mutable_graph());
+	bulky.mutable_stop_bus_index()->Swap(serialization_catalog_.mutable_stop_bus_index());
+	serialization_catalog_.clear_graph();
+	serialization_catalog_.clear_stop_bus_index();
+	
+	std::string proto;
+	const bool serialized = serialization_catalog_.SerializeToString(&proto);
+	
+	serialization_catalog_.mutable_stop()->Swap(bulky.mutable_stop());
+	serialization_catalog_.mutable_bus()->Swap(bulky.mutable_bus());
+	serialization_catalog_.mutable_map_distance()->Swap(bulky.mutable_map_distance());
+	serialization_catalog_.mutable_graph()->Swap(bulky.mutable_graph());
+	serialization_catalog_.mutable_stop_bus_index()->Swap(bulky.mutable_stop_bus_index());
+	if (!serialized) {
+		throw std::runtime_error("Can't serialize catalog settings");
+	}
+	
+	flat_base::Writer writer;
+	writer.AddSection(flat_base::SectionId::STRINGS, 1, strings.data(), strings.size());
+	writer.AddSection(flat_base::SectionId::STOPS, stops);
+	writer.AddSection(flat_base::SectionId::DISTANCES, distances);
+	writer.AddSection(flat_base::SectionId::BUSES, buses);
+	writer.AddSection(flat_base::SectionId::BUS_STOPS, bus_stops);
+	writer.AddSection(flat_base::SectionId::TIMETABLES, timetables);
+	if (!stop_bus_offsets.empty()) {
+		writer.AddSection(flat_base::SectionId::STOP_BUS_OFFSETS, stop_bus_offsets);
+		writer.AddSection(flat_base::SectionId::STOP_BUS_IDS, stop_bus_ids);
+	}
+	writer.AddSection(flat_base::SectionId::EDGES, edges);
+	writer.AddSection(flat_base::SectionId::INCIDENCE_OFFSETS, incidence_offsets);
+	writer.AddSection(flat_base::SectionId::INCIDENCE_EDGES, incidence_edges);
+	writer.AddSection(flat_base::SectionId::PROTO, 1, proto.data(), proto.size());
+	if (!flat_route_prev_edges_.empty()) {
+		if (!flat_route_compact_weights_.empty()) {
+			writer.AddSection(flat_base::SectionId::ROUTE_COMPACT_WEIGHTS, flat_route_compact_weights_);
+		} else {
+			writer.AddSection(flat_base::SectionId::ROUTE_WEIGHTS, flat_route_weights_);
+		}
+		writer.AddSection(flat_base::SectionId::ROUTE_PREV_EDGES, flat_route_prev_edges_);
+	}
+	writer.Save(GetTempFile(file_));
+	ReplaceBase(file_);
+}
+
+namespace {
+
+domain::RoutingSetting ConvertRoutingSetting(const catalog_buf::RoutingSetting& settings_pb) {
+	domain::RoutingSetting routing_setting;
+	routing_setting.wait_time = settings_pb.wait_time();
+	routing_setting.bus_velocity = settings_pb.bus_velocity();
+	routing_setting.router_type = static_cast<domain::RouterType>(settings_pb.router_type());
+	routing_setting.graph_model = static_cast<domain::GraphModel>(settings_pb.graph_model());
+	routing_setting.route_table_precision = static_cast<domain::RouteTablePrecision>(settings_pb.route_table_precision());
+	routing_setting.landmark_count = settings_pb.landmark_count();
+	routing_setting.route_criterion = static_cast<domain::RouteCriterion>(settings_pb.route_criterion());
+	return routing_setting;
+}
+
+}  // namespace
+
 int Serialization::GetStopCount() {
+    if (flat_base_) {
+        return static_cast<int>(flat_base_->GetSection<flat_base::StopRecord>(flat_base::SectionId::STOPS).size);
+    }
     return serialization_catalog_.stop_size();
 }
 
 std::tuple<std::string, double, double> Serialization::GetStopData(int i) {
+    if (flat_base_) {
+        const auto& stop = flat_base_->GetSection<flat_base::StopRecord>(flat_base::SectionId::STOPS).Sub(i, 1)[0];
+        return std::make_tuple(std::string(flat_base_->GetString(stop.name_offset, stop.name_size)), stop.lat, stop.lng);
+    }
     auto stop = serialization_catalog_.stop(i);
     return std::make_tuple(stop.stop_name(), stop.point().lat(), stop.point().lng());
 }
 
 int Serialization::GetMapSize() {
+    if (flat_base_) {
+        return static_cast<int>(flat_base_->GetSection<flat_base::DistanceRecord>(flat_base::SectionId::DISTANCES).size);
+    }
     return serialization_catalog_.map_distance_size();
 }
 
 std::tuple<int, int, double> Serialization::GetMapData(int i) {
+    if (flat_base_) {
+        const auto& dist = flat_base_->GetSection<flat_base::DistanceRecord>(flat_base::SectionId::DISTANCES).Sub(i, 1)[0];
+        return std::make_tuple(static_cast<int>(dist.from), static_cast<int>(dist.to), dist.distance);
+    }
     auto dist = serialization_catalog_.map_distance(i);
     return std::make_tuple(dist.stop_id_from(), dist.stop_id_to(), dist.distance());
 }
 
 int Serialization::GetBusCount() {
+	if (flat_base_) {
+		return static_cast<int>(flat_base_->GetSection<flat_base::BusRecord>(flat_base::SectionId::BUSES).size);
+	}
 	return serialization_catalog_.bus_size();
 }
 
+flat_base::BusRecord Serialization::GetFlatBus(int i) const {
+  return flat_base_->GetSection<flat_base::BusRecord>(flat_base::SectionId::BUSES).Sub(i, 1)[0];
+}
+
 std::string Serialization::GetBusName(int i) {
+  if (flat_base_) {
+	const flat_base::BusRecord bus = GetFlatBus(i);
+	return std::string(flat_base_->GetString(bus.name_offset, bus.name_size));
+  }
   return serialization_catalog_.bus(i).bus_name();
 }
 
 bool Serialization::GetRoundTripFlag(int i) {
+  if (flat_base_) {
+	return GetFlatBus(i).round_trip != 0;
+  }
   return serialization_catalog_.bus(i).round_trip();
 }
 
 std::vector<int> Serialization::GetStopsId(int i) {
+  if (flat_base_) {
+	const flat_base::BusRecord bus = GetFlatBus(i);
+	const auto stops = flat_base_->GetSection<std::uint32_t>(flat_base::SectionId::BUS_STOPS).Sub(bus.stops_begin, bus.stop_count);
+	return std::vector<int>(stops.begin(), stops.end());
+  }
   std::vector<int> stops_id;
   for (auto& id :  serialization_catalog_.bus(i).stop_num()) {
 	stops_id.push_back(id);
@@ -256,8 +801,49 @@ std::vector<int> Serialization::GetStopsId(int i) {
   return stops_id;
 }
 
+std::vector<int> Serialization::GetBusTimetable(int i) {
+  if (flat_base_) {
+	const flat_base::BusRecord bus = GetFlatBus(i);
+	const auto timetable = flat_base_->GetSection<std::int32_t>(flat_base::SectionId::TIMETABLES).Sub(bus.timetable_begin, bus.timetable_size);
+	return std::vector<int>(timetable.begin(), timetable.end());
+  }
+  std::vector<int> timetable;
+  int departure = 0;
+  for (int delta : serialization_catalog_.bus(i).timetable()) {
+	departure += delta;
+	timetable.push_back(departure);
+  }
+  return timetable;
+}
+
+std::optional<domain::StopBusIndex> Serialization::GetStopBusIndex() {
+  if (flat_base_) {
+	if (!flat_base_->HasSection(flat_base::SectionId::STOP_BUS_OFFSETS)) {
+	  return std::nullopt;
+	}
+	const auto offsets = flat_base_->GetSection<std::uint32_t>(flat_base::SectionId::STOP_BUS_OFFSETS);
+	const auto bus_ids = flat_base_->GetSection<std::uint32_t>(flat_base::SectionId::STOP_BUS_IDS);
+	domain::StopBusIndex stop_bus_index;
+	stop_bus_index.offsets.assign(offsets.begin(), offsets.end());
+	stop_bus_index.bus_ids.assign(bus_ids.begin(), bus_ids.end());
+	return stop_bus_index;
+  }
+  if (!serialization_catalog_.has_stop_bus_index()) {
+	return std::nullopt;
+  }
+  const auto& index_pb = serialization_catalog_.stop_bus_index();
+  domain::StopBusIndex stop_bus_index;
+  stop_bus_index.offsets.assign(index_pb.offsets().begin(), index_pb.offsets().end());
+  stop_bus_index.bus_ids.assign(index_pb.bus_ids().begin(), index_pb.bus_ids().end());
+  return stop_bus_index;
+}
+
 // Десериализуем каталог
 void Serialization::DeserializeTransportCatalogue(catalog::TransportCatalogue& load_catalog) {
+    if (flat_base_) {
+        DeserializeFlatCatalogue(load_catalog);
+        return;
+    }
    
     int size = GetStopCount();
     
@@ -266,25 +852,30 @@ void Serialization::DeserializeTransportCatalogue(catalog::TransportCatalogue& l
 	  load_catalog.AddStop(stop.stop_name(), stop.point().lat(), stop.point().lng());
 	}
 	
-	size = serialization_catalog_.map_distance_size();
-    for (int i = 0; i < size; ++i) {
-    auto dist = serialization_catalog_.map_distance(i);
-	load_catalog.SetDistance(load_catalog.FindStop(std::string(load_catalog.GetStopNameFromId(dist.stop_id_from()))),  load_catalog.FindStop(std::string(load_catalog.GetStopNameFromId(dist.stop_id_to()))), dist.distance());
+	for (const auto& dist : serialization_catalog_.map_distance()) {
+		load_catalog.SetDistance(load_catalog.GetStopById(dist.stop_id_from()), load_catalog.GetStopById(dist.stop_id_to()), dist.distance());
 	}
 	
     size = serialization_catalog_.bus_size();
-	for (auto& bus : serialization_catalog_.bus()) {
-     
-        std::vector<std::string_view> stops;
+	for (int i = 0; i < size; ++i) {
+        const auto& bus = serialization_catalog_.bus(i);
+        const std::vector<domain::StopId> stop_ids(bus.stop_num().begin(), bus.stop_num().end());
 
-        for (auto& stop_id : bus.stop_num()) {
-            stops.push_back(load_catalog.GetStopNameFromId(stop_id));
+        load_catalog.AddBus(bus.bus_name(), stop_ids, bus.round_trip());
+        if (bus.timetable_size() > 0) {
+            load_catalog.SetBusTimetable(bus.bus_name(), GetBusTimetable(i));
         }
-
-        load_catalog.AddBus(bus.bus_name(), stops, bus.round_trip());
 	}
 	
-	load_catalog.AddRoutingSetting(serialization_catalog_.routing_setting().wait_time(), serialization_catalog_.routing_setting().bus_velocity());	
+	// индекс из базы старой версии строится заново
+	if (auto stop_bus_index = GetStopBusIndex()) {
+		load_catalog.SetStopBusIndex(std::move(*stop_bus_index));
+	} else {
+		load_catalog.BuildStopBusIndex();
+	}
+	load_catalog.BuildBusStats();
+	
+	load_catalog.AddRoutingSetting(ConvertRoutingSetting(serialization_catalog_.routing_setting()));
 	
 	std::vector<graph::Edge<double>> add_edges;
 	for (auto& edge_pb : serialization_catalog_.graph().edges()) {
@@ -305,13 +896,228 @@ void Serialization::DeserializeTransportCatalogue(catalog::TransportCatalogue& l
 		for (auto& id : serialization_catalog_.graph().incidence_lists(i).edge_id()) {
 			ids.push_back(static_cast<size_t>(id));
 		}
-		incidence_lists.push_back(ids);
+		incidence_lists[i] = std::move(ids);
 	}
 	
 	load_catalog.InitDeserializeRouterGraph(add_edges, incidence_lists);
 
 }
 
+// Заполняет каталог записями отображенной базы: названия берутся из секции STRINGS без промежуточных строк,
+// остановки расстояний и маршрутов, маршруты ребер - по номерам
+void Serialization::DeserializeFlatCatalogue(catalog::TransportCatalogue& load_catalog) {
+	using flat_base::SectionId;
+	
+	for (const auto& stop : flat_base_->GetSection<flat_base::StopRecord>(SectionId::STOPS)) {
+		load_catalog.AddStop(flat_base_->GetString(stop.name_offset, stop.name_size), stop.lat, stop.lng);
+	}
+	
+	for (const auto& dist : flat_base_->GetSection<flat_base::DistanceRecord>(SectionId::DISTANCES)) {
+		load_catalog.SetDistance(load_catalog.GetStopById(dist.from), load_catalog.GetStopById(dist.to), dist.distance);
+	}
+	
+	const auto bus_stops = flat_base_->GetSection<std::uint32_t>(SectionId::BUS_STOPS);
+	const auto timetables = flat_base_->GetSection<std::int32_t>(SectionId::TIMETABLES);
+	std::vector<domain::StopId> stop_ids;
+	for (const auto& bus : flat_base_->GetSection<flat_base::BusRecord>(SectionId::BUSES)) {
+		const std::string_view bus_name = flat_base_->GetString(bus.name_offset, bus.name_size);
+		const auto stops = bus_stops.Sub(bus.stops_begin, bus.stop_count);
+		stop_ids.assign(stops.begin(), stops.end());
+		
+		load_catalog.AddBus(bus_name, stop_ids, bus.round_trip != 0);
+		if (bus.timetable_size > 0) {
+			const auto timetable = timetables.Sub(bus.timetable_begin, bus.timetable_size);
+			load_catalog.SetBusTimetable(bus_name, std::vector<int>(timetable.begin(), timetable.end()));
+		}
+	}
+	
+	if (auto stop_bus_index = GetStopBusIndex()) {
+		load_catalog.SetStopBusIndex(std::move(*stop_bus_index));
+	} else {
+		load_catalog.BuildStopBusIndex();
+	}
+	load_catalog.BuildBusStats();
+	
+	load_catalog.AddRoutingSetting(ConvertRoutingSetting(serialization_catalog_.routing_setting()));
+	
+	const auto incidence_offsets = flat_base_->GetSection<std::uint32_t>(SectionId::INCIDENCE_OFFSETS);
+	const auto incidence_edges = flat_base_->GetSection<std::uint32_t>(SectionId::INCIDENCE_EDGES);
+	const size_t vertex_count = incidence_offsets.size > 0 ? incidence_offsets.size - 1 : 0;
+	
+	const auto edge_records = flat_base_->GetSection<flat_base::EdgeRecord>(SectionId::EDGES);
+	std::vector<graph::Edge<double>> edges;
+	edges.reserve(edge_records.size);
+	for (const auto& edge_record : edge_records) {
+		if (edge_record.from >= vertex_count || edge_record.to >= vertex_count) {
+			throw std::runtime_error("Flat base edge refers to a vertex out of the graph");
+		}
+		graph::Edge<double> edge;
+		edge.from = edge_record.from;
+		edge.to = edge_record.to;
+		edge.weight = edge_record.weight;
+		edge.stops_count = edge_record.stops_count;
+		edge.bus = edge_record.bus_id == flat_base::EdgeRecord::NO_BUS ? nullptr : load_catalog.GetBusById(edge_record.bus_id);
+		edges.push_back(edge);
+	}
+	
+	std::vector<std::vector<size_t>> incidence_lists(vertex_count);
+	for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+		if (incidence_offsets[vertex + 1] < incidence_offsets[vertex]) {
+			throw std::runtime_error("Flat base incidence offsets are not sorted");
+		}
+		const auto list = incidence_edges.Sub(incidence_offsets[vertex], incidence_offsets[vertex + 1] - incidence_offsets[vertex]);
+		for (const std::uint32_t edge_id : list) {
+			if (edge_id >= edges.size()) {
+				throw std::runtime_error("Flat base incidence list refers to an edge out of the graph");
+			}
+		}
+		incidence_lists[vertex].assign(list.begin(), list.end());
+	}
+	
+	load_catalog.InitDeserializeRouterGraph(std::move(edges), std::move(incidence_lists));
+}
+
+// Массивы таблицы путей читаются из отображенного файла одним копированием, без разбора сообщения
+void Serialization::ExtractFlatRouterData(transport_router::PrecomputedData& precomputed) const {
+	using flat_base::SectionId;
+	using PrevEdge = graph::RoutesTable<double>::PrevEdge;
+	
+	const auto incidence_offsets = flat_base_->GetSection<std::uint32_t>(SectionId::INCIDENCE_OFFSETS);
+	const size_t vertex_count = incidence_offsets.size > 0 ? incidence_offsets.size - 1 : 0;
+	const auto prev_edges = flat_base_->GetSection<PrevEdge>(SectionId::ROUTE_PREV_EDGES);
+	CheckRoutesTableSize(vertex_count, prev_edges.size, "prev_edge");
+	
+	if (flat_base_->HasSection(SectionId::ROUTE_COMPACT_WEIGHTS)) {
+		const auto weights = flat_base_->GetSection<float>(SectionId::ROUTE_COMPACT_WEIGHTS);
+		CheckRoutesTableSize(vertex_count, weights.size, "compact_weight");
+		graph::RoutesTable<float> routes_table;
+		routes_table.vertex_count = vertex_count;
+		routes_table.weights.assign(weights.begin(), weights.end());
+		routes_table.prev_edges.assign(prev_edges.begin(), prev_edges.end());
+		precomputed.compact_routes_table = std::move(routes_table);
+		return;
+	}
+	
+	const auto weights = flat_base_->GetSection<double>(SectionId::ROUTE_WEIGHTS);
+	CheckRoutesTableSize(vertex_count, weights.size, "weight");
+	if (serialization_catalog_.routing_setting().router_type() == catalog_buf::BLOCKED_FLOYD_WARSHALL) {
+		graph::RoutesTable<double> routes_table;
+		routes_table.vertex_count = vertex_count;
+		routes_table.weights.assign(weights.begin(), weights.end());
+		routes_table.prev_edges.assign(prev_edges.begin(), prev_edges.end());
+		precomputed.routes_table = std::move(routes_table);
+		return;
+	}
+	
+	graph::Router<double>::RoutesInternalData routes_internal_data(vertex_count, 
+		std::vector<std::optional<graph::Router<double>::RouteInternalData>>(vertex_count));
+	for (size_t from = 0; from < vertex_count; ++from) {
+		for (size_t to = 0; to < vertex_count; ++to) {
+			const size_t i = from * vertex_count + to;
+			if (std::isinf(weights[i])) {
+				continue;
+			}
+			routes_internal_data[from][to] = graph::Router<double>::RouteInternalData{weights[i], 
+				prev_edges[i] == graph::RoutesTable<double>::NO_EDGE ? std::nullopt : std::optional<graph::EdgeId>(prev_edges[i])};
+		}
+	}
+	precomputed.routes_internal_data = std::move(routes_internal_data);
+}
+
+transport_router::PrecomputedData Serialization::ExtractRouterData() {
+	transport_router::PrecomputedData precomputed;
+	
+	if (flat_base_ && flat_base_->HasSection(flat_base::SectionId::ROUTE_PREV_EDGES)) {
+		ExtractFlatRouterData(precomputed);
+	}
+	
+	// таблица в формате блочного алгоритма загружается без перекладывания в вектор векторов
+	if (serialization_catalog_.has_router_data() 
+		&& serialization_catalog_.routing_setting().router_type() == catalog_buf::BLOCKED_FLOYD_WARSHALL) {
+		const auto& router_data_pb = serialization_catalog_.router_data();
+		
+		if (serialization_catalog_.routing_setting().route_table_precision() == catalog_buf::FLOAT) {
+			graph::RoutesTable<float> routes_table;
+			ExtractRoutesTablePrevEdges(router_data_pb, routes_table);
+			CheckRoutesTableSize(routes_table.vertex_count, router_data_pb.compact_weight_size(), "compact_weight");
+			routes_table.weights.assign(router_data_pb.compact_weight().begin(), router_data_pb.compact_weight().end());
+			precomputed.compact_routes_table = std::move(routes_table);
+		} else {
+			graph::RoutesTable<double> routes_table;
+			ExtractRoutesTablePrevEdges(router_data_pb, routes_table);
+			CheckRoutesTableSize(routes_table.vertex_count, router_data_pb.weight_size(), "weight");
+			routes_table.weights.assign(router_data_pb.weight().begin(), router_data_pb.weight().end());
+			precomputed.routes_table = std::move(routes_table);
+		}
+		serialization_catalog_.clear_router_data();
+	}
+	
+	if (serialization_catalog_.has_router_data()) {
+		const auto& router_data_pb = serialization_catalog_.router_data();
+		const size_t vertex_count = static_cast<size_t>(router_data_pb.vertex_count());
+		CheckRoutesTableSize(vertex_count, router_data_pb.weight_size(), "weight");
+		CheckRoutesTableSize(vertex_count, router_data_pb.prev_edge_size(), "prev_edge");
+		
+		graph::Router<double>::RoutesInternalData routes_internal_data(vertex_count, 
+			std::vector<std::optional<graph::Router<double>::RouteInternalData>>(vertex_count));
+		
+		for (size_t from = 0; from < vertex_count; ++from) {
+			for (size_t to = 0; to < vertex_count; ++to) {
+				const size_t i = from * vertex_count + to;
+				const double weight = router_data_pb.weight(i);
+				if (std::isinf(weight)) {
+					continue;
+				}
+				const int prev_edge = router_data_pb.prev_edge(i);
+				routes_internal_data[from][to] = graph::Router<double>::RouteInternalData{weight, 
+					prev_edge < 0 ? std::nullopt : std::optional<graph::EdgeId>(prev_edge)};
+			}
+		}
+		
+		precomputed.routes_internal_data = std::move(routes_internal_data);
+		serialization_catalog_.clear_router_data();
+	}
+	
+	if (serialization_catalog_.has_contraction_hierarchy()) {
+		const auto& hierarchy_pb = serialization_catalog_.contraction_hierarchy();
+		
+		graph::ContractionHierarchyData<double> hierarchy;
+		hierarchy.ranks.reserve(hierarchy_pb.rank_size());
+		for (auto rank : hierarchy_pb.rank()) {
+			hierarchy.ranks.push_back(static_cast<size_t>(rank));
+		}
+		
+		hierarchy.shortcuts.reserve(hierarchy_pb.shortcuts_size());
+		for (auto& shortcut_pb : hierarchy_pb.shortcuts()) {
+			graph::Shortcut<double> shortcut;
+			shortcut.from = shortcut_pb.from();
+			shortcut.to = shortcut_pb.to();
+			shortcut.weight = shortcut_pb.weight();
+			shortcut.first = shortcut_pb.first_edge();
+			shortcut.second = shortcut_pb.second_edge();
+			hierarchy.shortcuts.push_back(shortcut);
+		}
+		
+		precomputed.hierarchy = std::move(hierarchy);
+		serialization_catalog_.clear_contraction_hierarchy();
+	}
+	
+	if (serialization_catalog_.has_landmarks()) {
+		const auto& landmarks_pb = serialization_catalog_.landmarks();
+		
+		graph::LandmarkData<double> landmarks;
+		landmarks.vertex_count = static_cast<size_t>(landmarks_pb.vertex_count());
+		landmarks.landmarks.assign(landmarks_pb.vertex().begin(), landmarks_pb.vertex().end());
+		landmarks.from_landmarks.assign(landmarks_pb.from_landmark().begin(), landmarks_pb.from_landmark().end());
+		landmarks.to_landmarks.assign(landmarks_pb.to_landmark().begin(), landmarks_pb.to_landmark().end());
+		
+		precomputed.landmarks = std::move(landmarks);
+		serialization_catalog_.clear_landmarks();
+	}
+	
+	return precomputed;
+}
+
 double Serialization::GetRenderWidth() {
 	return serialization_catalog_.render_settings().width();
 }
@@ -388,6 +1194,15 @@ int Serialization::GetPaletteSize() {
 
 // Загружает сериализованный каталог из file_
 void Serialization::LoadFrom() {
+	// плоская база отображается в память, разбирается только сообщение с настройками
+	if (flat_base::IsFlatBase(file_)) {
+		flat_base_ = std::make_unique<flat_base::MappedBase>(file_);
+		const auto proto = flat_base_->GetSection<char>(flat_base::SectionId::PROTO);
+		if (!serialization_catalog_.ParseFromArray(proto.data, static_cast<int>(proto.size))) {
+			throw std::runtime_error("Flat base " + file_ + " has corrupted settings");
+		}
+		return;
+	}
 	std::ifstream ifs(file_, std::ios::binary);
     if (!serialization_catalog_.ParseFromIstream(&ifs)) {
         std::cout << "Fatal ERROR" << std::endl;
@@ -13,19 +13,34 @@
 
 
 #include <transport_catalogue.pb.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
 #include "svg.h"
 #include "domain.h"
+#include "flat_base.h"
 #include "graph.h"
+#include "ranges.h"
+#include "router.h"
 #include "transport_catalogue.h"
+#include "transport_router.h"
 
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <tuple>
 #include <unordered_map>
 #include <variant>
 
 namespace serialization {
+
+/// Формат файла базы
+enum class BaseFormat {
+	PROTOBUF,       ///< Сообщение catalog_buf::Catalog
+	FLAT,           ///< Плоский формат flat_base: остановки, маршруты, расстояния и граф читаются из отображенного файла
+};
+
 /*!
  * @brief Реализация класса сериализации транспортного каталога
  * @class Serialization
@@ -39,15 +54,46 @@ class Serialization {
 public:
 	void SetFilePath(std::string file_path);
 	
+	/// Формат, в котором SaveTo записывает базу (LoadFrom определяет формат по файлу)
+	void SetFormat(BaseFormat format);
+	
+	/*!
+	 * Начинает потоковую запись базы в формате PROTOBUF: остановки, расстояния, маршруты, граф
+	 * и таблицы движков поиска маршрутов записываются в файл сразу при добавлении отдельными полями
+	 * сообщения catalog_buf::Catalog, в памяти до SaveTo остаются только настройки.
+	 * Запись идет во временный файл рядом с базой, SaveTo заменяет им базу только после успешной записи.
+	 * Для формата FLAT ничего не делает - плоская база собирается в памяти целиком
+	 * 
+	 * @throw std::runtime_error файл не удалось открыть
+	 */
+	void BeginSave();
+	
 	void InitSerializationStop(std::string stop_name,  double lat, double lng);
 	
 	void InitSerializationDistance(int stop_id_from, int stop_id_to,  double distance);
 	
-	void InitSerializationBus(std::string bus_name, bool round_trip, std::vector<int> bus_stops);
+	/// Добавляет все расстояния (id остановки отправления, id остановки прибытия, расстояние) за один проход
+	void InitSerializationDistances(const std::vector<std::tuple<int, int, double>>& distances);
+	
+	void InitSerializationBus(std::string bus_name, bool round_trip, std::vector<int> bus_stops, const std::vector<int>& timetable = {});
+	
+	void InitRoutingSettings(const domain::RoutingSetting& routing_setting);
+	
+	void InitStopBusIndex(const domain::StopBusIndex& stop_bus_index);
+	
+	/// Добавляет ребро графа (ребра добавляются по возрастанию номеров)
+	void InitGraphEdge(const domain::ForSerializationGraph& edge);
+	
+	/// Добавляет номера ребер, выходящих из очередной вершины графа
+	void InitIncidenceList(graph::DirectedWeightedGraph<double>::IncidentEdgesRange edge_ids);
 	
-	void InitRoutingSettings(int wait_time, int bus_velocity);
+	void InitRouterData(const graph::Router<double>::RoutesInternalData& routes_internal_data);
+	void InitRouterData(const graph::RoutesTable<double>& routes_table);
+	void InitRouterData(const graph::RoutesTable<float>& routes_table);
 	
-	void InitGraph(std::vector<domain::ForSerializationGraph> edges, std::vector<std::vector<int>> edge_id);
+	void InitContractionHierarchy(const graph::ContractionHierarchyData<double>& hierarchy);
+	
+	void InitLandmarks(const graph::LandmarkData<double>& landmarks);
 	
 	void InitRenderSettiingsParam(double width, double heidht, double padding, double line_width, double stop_radius, int bus_lable_font_size, int stop_lable_font_size, double underlayer_width);
 	
@@ -70,8 +116,17 @@ public:
 	bool GetRoundTripFlag(int i);
 
 	std::vector<int> GetStopsId(int i);
+	
+	/// Расписание маршрута i (время отправления с каждой остановки рейса, рейсы подряд)
+	std::vector<int> GetBusTimetable(int i);
+	
+	/// Индекс "остановка -> маршруты", std::nullopt - в базе его нет (база предыдущей версии)
+	std::optional<domain::StopBusIndex> GetStopBusIndex();
     
     void DeserializeTransportCatalogue(catalog::TransportCatalogue& catalog);
+    
+    /// Возвращает сохраненные данные движков поиска маршрутов (если они есть) и освобождает занятую ими память
+    transport_router::PrecomputedData ExtractRouterData();
 	
 	double GetRenderWidth();
 	
@@ -97,12 +152,51 @@ public:
 	
 	std::pair<double, double> GetOffset(std::string what);
 	
+    /// std::runtime_error - база повреждена
     void LoadFrom();
     
-    void SaveTo() const;
+    void SaveTo();
 private:
 	std::string file_;
+	BaseFormat format_ = BaseFormat::PROTOBUF;
     catalog_buf::Catalog serialization_catalog_;
+    /// База в плоском формате, из которой загружен каталог (nullptr - база в формате protobuf)
+    std::unique_ptr<flat_base::MappedBase> flat_base_;
+    
+    /// Файл базы при потоковой записи (nullptr - каталог собирается в serialization_catalog_)
+    std::unique_ptr<std::ofstream> out_file_;
+    std::unique_ptr<google::protobuf::io::OstreamOutputStream> raw_output_;
+    std::unique_ptr<google::protobuf::io::CodedOutputStream> output_;
+    
+    /// Записывает message в файл базы полем field_number сообщения catalog_buf::Catalog
+    void WriteCatalogField(int field_number, const google::protobuf::MessageLite& message);
+    
+    /// Количество ребер и списков ребер в одной части графа при потоковой записи
+    static constexpr int GRAPH_CHUNK_SIZE = 4096;
+    /// Еще не записанная часть графа
+    catalog_buf::Graph graph_chunk_;
+    /// Записывает накопленную часть графа полем graph (части графа при разборе сливаются)
+    void FlushGraphChunk();
+    
+    /*!
+     * Записывает таблицу путей полем router_data по строкам, не собирая сообщение в памяти
+     * 
+     * @param get_weight(from, to) вес пути
+     * @param get_prev_edge(from, to) последнее ребро пути (-1 - нет)
+     */
+    template <typename StoredWeight, typename GetWeight, typename GetPrevEdge>
+    void WriteRouterData(size_t vertex_count, GetWeight get_weight, GetPrevEdge get_prev_edge);
+    
+    /// Таблица путей для формата FLAT: хранится массивами и записывается в базу отдельными секциями
+    std::vector<double> flat_route_weights_;
+    std::vector<float> flat_route_compact_weights_;
+    std::vector<std::uint32_t> flat_route_prev_edges_;
+    
+    void SaveFlatBase();
+    void DeserializeFlatCatalogue(catalog::TransportCatalogue& load_catalog);
+    /// Загружает таблицу путей из секций ROUTE_* отображенной базы
+    void ExtractFlatRouterData(transport_router::PrecomputedData& precomputed) const;
+    flat_base::BusRecord GetFlatBus(int i) const;
     
     catalog_buf::Color ConvertColor(std::monostate);
     catalog_buf::Color ConvertColor(std::string color);
@@ -0,0 +1,220 @@
+/*!
+ * @file transport_catalogue_tests.cpp
+ * @brief Тесты транспортного каталога: запросы make_base и process_requests проходят целиком
+ * через MakeBaseJSON и ProcessRequestsJSON с базой во временном файле
+ *
+ * @author Elistratov Anton
+ *
+ * @version 1.0
+ * @date Октябрь 2026
+*/
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "json.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "serialization.h"
+#include "transport_catalogue.h"
+
+using namespace std::literals;
+
+namespace {
+
+/// Прерывает тест с сообщением, если условие не выполнено
+#define CHECK(expr) \
+    if (!(expr)) { \
+        throw std::runtime_error(__FILE__ ":"s + std::to_string(__LINE__) + ": "s + #expr); \
+    }
+
+/// Файл базы, общий для всех тестов (тесты выполняются по очереди)
+std::string GetBaseFile() {
+    return (std::filesystem::temp_directory_path() / "transport_catalogue_tests.db").string();
+}
+
+/// Маршрут "1" A - B - C в обе стороны и кольцевой маршрут "2" C - D - C
+std::string MakeBaseRequests() {
+    return R"("base_requests": [
+        {"type": "Stop", "name": "A", "latitude": 55.60, "longitude": 37.60, "road_distances": {"B": 1000}},
+        {"type": "Stop", "name": "B", "latitude": 55.61, "longitude": 37.61, "road_distances": {"C": 2000}},
+        {"type": "Stop", "name": "C", "latitude": 55.62, "longitude": 37.62, "road_distances": {"D": 1500}},
+        {"type": "Stop", "name": "D", "latitude": 55.63, "longitude": 37.63, "road_distances": {"C": 1500}},
+        {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+        {"type": "Bus", "name": "2", "stops": ["C", "D", "C"], "is_roundtrip": true}
+    ])";
+}
+
+/*!
+ * Строит базу с маршрутами MakeBaseRequests и выполняет запросы статистики
+ *
+ * @param routing_settings содержимое routing_settings
+ * @param stat_requests содержимое массива stat_requests
+ *
+ * @return ответы на запросы
+ */
+json::Array RunRequests(const std::string& routing_settings, const std::string& stat_requests) {
+    const std::string serialization_settings = R"("serialization_settings": {"file": ")"s + GetBaseFile() + R"("})"s;
+    {
+        catalog::TransportCatalogue catalog;
+        map_renderer::MapRanderer map;
+        serialization::Serialization serialization;
+        std::istringstream input("{"s + MakeBaseRequests() + ", \"routing_settings\": {"s + routing_settings + "}, "s
+                                 + serialization_settings + "}"s);
+        MakeBaseJSON(catalog, map, serialization, input);
+        RequestHandler handler(catalog, map, catalog.GetGraph(), serialization);
+        handler.InitSerializationCatalog();
+        handler.SaveSerializationCatalog();
+    }
+
+    catalog::TransportCatalogue catalog;
+    map_renderer::MapRanderer map;
+    serialization::Serialization serialization;
+    std::istringstream input("{"s + serialization_settings + ", \"stat_requests\": ["s + stat_requests + "]}"s);
+    std::ostringstream output;
+    ProcessRequestsJSON(catalog, map, serialization, input, output);
+    std::remove(GetBaseFile().c_str());
+
+    std::istringstream answers(output.str());
+    return json::Load(answers).GetRoot().AsArray();
+}
+
+/// Текст ошибки в ответе на запрос (пустая строка - ответ без ошибки)
+std::string GetErrorMessage(const json::Node& answer) {
+    const auto& dict = answer.AsDict();
+    return dict.count("error_message") ? dict.at("error_message").AsString() : ""s;
+}
+
+/// Количество ребер графа маршрутов, построенного в make_base для маршрута bus_stops
+size_t CountGraphEdges(const std::string& graph_model, const std::string& bus_stops) {
+    catalog::TransportCatalogue catalog;
+    map_renderer::MapRanderer map;
+    serialization::Serialization serialization;
+    std::istringstream input(R"({"base_requests": [)"s + bus_stops + R"(], "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30, "graph_model": ")"s
+                             + graph_model + R"("}})"s);
+    MakeBaseJSON(catalog, map, serialization, input);
+    return catalog.GetGraph().GetEdgeCount();
+}
+
+/// Некольцевой маршрут из stop_count остановок, стоящих на одной линии в 500 м друг от друга
+std::string MakeLineBus(size_t stop_count) {
+    std::string requests;
+    for (size_t i = 0; i < stop_count; ++i) {
+        requests += R"({"type": "Stop", "name": "S)"s + std::to_string(i) + R"(", "latitude": 55.6, "longitude": )"s
+                    + std::to_string(37.6 + i * 0.005) + R"(, "road_distances": {)"s
+                    + (i + 1 < stop_count ? R"("S)"s + std::to_string(i + 1) + R"(": 500)"s : ""s) + "}},"s;
+    }
+    requests += R"({"type": "Bus", "name": "line", "is_roundtrip": false, "stops": [)"s;
+    for (size_t i = 0; i < stop_count; ++i) {
+        requests += (i ? ", "s : ""s) + R"("S)"s + std::to_string(i) + R"(")"s;
+    }
+    return requests + "]}"s;
+}
+
+void TestRideVerticesEdgeCountIsLinear() {
+    for (size_t stop_count : {10, 100, 400}) {
+        const std::string bus = MakeLineBus(stop_count);
+        // у некругового маршрута две цепочки вершин "в автобусе" по stop_count вершин:
+        // посадка и высадка на каждой вершине и проезд между соседними
+        CHECK(CountGraphEdges("ride_vertices"s, bus) == 2 * (3 * stop_count - 1));
+        // ребро на каждую пару остановок в обе стороны
+        CHECK(CountGraphEdges("stop_pairs"s, bus) == stop_count * (stop_count - 1));
+    }
+}
+
+void TestRouteMatrixUnknownStop() {
+    const json::Array answers = RunRequests(R"("bus_wait_time": 2, "bus_velocity": 30)"s, R"(
+        {"id": 1, "type": "RouteMatrix", "from": ["A", "D"], "to": ["C", "A"]},
+        {"id": 2, "type": "RouteMatrix", "from": ["A", "Unknown"], "to": ["C"]},
+        {"id": 3, "type": "RouteMatrix", "from": ["A"], "to": ["Unknown"]},
+        {"id": 4, "type": "Route", "from": "A", "to": "C"})"s);
+    CHECK(answers.size() == 4);
+    
+    const json::Array& total_times = answers[0].AsDict().at("total_times").AsArray();
+    CHECK(total_times.size() == 2);
+    CHECK(total_times[0].AsArray().size() == 2);
+    // 3 км со скоростью 30 км/ч - 6 минут и 2 минуты ожидания
+    CHECK(total_times[0].AsArray()[0].AsDouble() == 8);
+    CHECK(total_times[0].AsArray()[1].AsDouble() == 0);
+    
+    CHECK(GetErrorMessage(answers[1]) == "not found"s);
+    CHECK(GetErrorMessage(answers[2]) == "not found"s);
+    // ошибка в одном запросе не прерывает обработку остальных
+    CHECK(answers[3].AsDict().at("total_time").AsDouble() == 8);
+}
+
+void TestRouteAlternativesUnknownStop() {
+    const json::Array answers = RunRequests(R"("bus_wait_time": 2, "bus_velocity": 30)"s, R"(
+        {"id": 1, "type": "RouteAlternatives", "from": "Unknown", "to": "C"},
+        {"id": 2, "type": "RouteAlternatives", "from": "A", "to": "Unknown"},
+        {"id": 3, "type": "Route", "from": "Unknown", "to": "C"},
+        {"id": 4, "type": "RouteAlternatives", "from": "A", "to": "D"})"s);
+    CHECK(answers.size() == 4);
+    CHECK(GetErrorMessage(answers[0]) == "not found"s);
+    CHECK(GetErrorMessage(answers[1]) == "not found"s);
+    CHECK(GetErrorMessage(answers[2]) == "not found"s);
+    CHECK(!answers[3].AsDict().at("alternatives").AsArray().empty());
+}
+
+void TestUpdateErrors() {
+    const json::Array answers = RunRequests(R"("bus_wait_time": 2, "bus_velocity": 30, "router_type": "dijkstra")"s, R"(
+        {"id": 1, "type": "UpdateDistance", "from": "Unknown", "to": "B", "distance": 100},
+        {"id": 2, "type": "UpdateDistance", "from": "A", "to": "B", "distance": -1},
+        {"id": 3, "type": "UpdateRoutingSettings", "bus_wait_time": -1, "bus_velocity": 30},
+        {"id": 4, "type": "UpdateRoutingSettings", "bus_wait_time": 2, "bus_velocity": 0},
+        {"id": 5, "type": "Route", "from": "A", "to": "C"},
+        {"id": 6, "type": "UpdateDistance", "from": "A", "to": "B", "distance": 2000},
+        {"id": 7, "type": "Route", "from": "A", "to": "C"})"s);
+    CHECK(answers.size() == 7);
+    CHECK(GetErrorMessage(answers[0]) == "not found"s);
+    CHECK(GetErrorMessage(answers[1]) == "distance should be non-negative"s);
+    CHECK(GetErrorMessage(answers[2]) == "bus_wait_time should be non-negative"s);
+    CHECK(GetErrorMessage(answers[3]) == "bus_velocity should be positive"s);
+    // отклоненные изменения не трогают каталог
+    CHECK(answers[4].AsDict().at("total_time").AsDouble() == 8);
+    CHECK(answers[5].AsDict().at("updated_edges").AsInt() > 0);
+    CHECK(answers[6].AsDict().at("total_time").AsDouble() == 10);
+}
+
+void TestIsochroneNotFound() {
+    const json::Array answers = RunRequests(R"("bus_wait_time": 2, "bus_velocity": 30)"s, R"(
+        {"id": 1, "type": "Isochrone", "from": "Unknown", "max_time": 10},
+        {"id": 2, "type": "Isochrone", "from": "A", "max_time": -1},
+        {"id": 3, "type": "Isochrone", "from": "A", "max_time": 4})"s);
+    CHECK(answers.size() == 3);
+    CHECK(GetErrorMessage(answers[0]) == "not found"s);
+    CHECK(GetErrorMessage(answers[1]) == "not found"s);
+    // за 4 минуты доезжаем только до B: 1 км - 2 минуты и 2 минуты ожидания
+    const json::Array& items = answers[2].AsDict().at("items").AsArray();
+    CHECK(items.size() == 2);
+    CHECK(items[1].AsDict().at("stop_name").AsString() == "B"s);
+}
+
+}  // namespace
+
+int main() {
+    const std::pair<const char*, std::function<void()>> tests[] = {
+        {"TestRideVerticesEdgeCountIsLinear", TestRideVerticesEdgeCountIsLinear},
+        {"TestRouteMatrixUnknownStop", TestRouteMatrixUnknownStop},
+        {"TestRouteAlternativesUnknownStop", TestRouteAlternativesUnknownStop},
+        {"TestUpdateErrors", TestUpdateErrors},
+        {"TestIsochroneNotFound", TestIsochroneNotFound},
+    };
+
+    int failed = 0;
+    for (const auto& [name, test] : tests) {
+        try {
+            test();
+            std::cerr << name << " OK\n";
+        } catch (const std::exception& e) {
+            std::cerr << name << " FAILED: " << e.what() << '\n';
+            ++failed;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -4,10 +4,11 @@ using namespace catalog;
 
 TransportCatalogue::TransportCatalogue(TransportCatalogue& other) 
   : stops_(other.stops_)
-  , stopname_to_stop_(other.stopname_to_stop_)
-  , stopname_to_buses_(other.stopname_to_buses_)
+  , stop_ids_(other.stop_ids_)
+  , stop_bus_index_(other.stop_bus_index_)
   , buses_(other.buses_)
-  , busname_to_bus_(other.busname_to_bus_)
+  , bus_ids_(other.bus_ids_)
+  , bus_stats_(other.bus_stats_)
   , distance_(other.distance_)
   , routing_setting_(other.routing_setting_)
   , router_graph_(other.router_graph_)
@@ -15,37 +16,139 @@ TransportCatalogue::TransportCatalogue(TransportCatalogue& other)
 }
 
 void TransportCatalogue::AddBus(std::string_view name, std::vector<std::string_view>& stops_name, bool flag) {
-    std::vector<domain::Stop*> ptr_stops;
-    
+    std::vector<domain::StopId> stop_ids;
+    stop_ids.reserve(stops_name.size());
     for (auto stop_name : stops_name) {
-        ptr_stops.push_back(stopname_to_stop_.at(stop_name));
+        stop_ids.push_back(stop_ids_.At(stop_name));
     }
+    AddBus(name, stop_ids, flag);
+}
 
-    std::sort(stops_name.begin(), stops_name.end());
-    auto last = std::unique(stops_name.begin(), stops_name.end());
-    int uni = last - stops_name.begin();
+void TransportCatalogue::AddBus(std::string_view name, const std::vector<domain::StopId>& stop_ids, bool flag) {
+    std::vector<domain::Stop*> ptr_stops;
+    ptr_stops.reserve(stop_ids.size());
+    for (auto stop_id : stop_ids) {
+        ptr_stops.push_back(&stops_.at(stop_id));
+    }
 
-    auto& ref = buses_.emplace_back(std::string(name), ptr_stops, flag, uni);
-    std::string_view bus_sw = ref.bus;
-    busname_to_bus_[bus_sw] = &ref;
-    
-    for (auto stop_name : ptr_stops) {
-        stopname_to_buses_[stop_name->stop_name].emplace(bus_sw);
+    std::vector<domain::StopId> unique_ids(stop_ids);
+    std::sort(unique_ids.begin(), unique_ids.end());
+    int uni = std::unique(unique_ids.begin(), unique_ids.end()) - unique_ids.begin();
+
+    const auto bus_id = static_cast<domain::BusId>(buses_.size());
+    auto& ref = buses_.emplace_back(std::string(name), std::move(ptr_stops), flag, uni, bus_id);
+    ResolveBusDistances(ref);
+    bus_ids_.Add(ref.bus);
+    stop_bus_index_ = {};
+    bus_stats_.clear();
+}
+
+void TransportCatalogue::SetBusTimetable(std::string_view name, std::vector<int> timetable) {
+    domain::Bus* bus = &buses_[bus_ids_.At(name)];
+    const size_t trip_stop_count = bus->GetTripStopCount();
+    if (trip_stop_count == 0 || timetable.size() % trip_stop_count != 0) {
+        throw std::invalid_argument("Timetable of bus " + bus->bus + " doesn't match its stops");
     }
+    for (size_t trip = 0; trip < timetable.size(); trip += trip_stop_count) {
+        if (!std::is_sorted(timetable.begin() + trip, timetable.begin() + trip + trip_stop_count)) {
+            throw std::invalid_argument("Departures of a trip of bus " + bus->bus + " should not decrease");
+        }
+    }
+    bus->timetable = std::move(timetable);
+}
+
+const std::vector<int>& TransportCatalogue::GetBusTimetable(std::string_view name) const {
+    return buses_[bus_ids_.At(name)].timetable;
+}
+
+std::vector<const domain::Bus*> TransportCatalogue::GetBusesWithTimetable() const {
+    std::vector<const domain::Bus*> buses;
+    for (auto& bus : buses_) {
+        if (!bus.timetable.empty()) {
+            buses.push_back(&bus);
+        }
+    }
+    return buses;
 }
 
 void TransportCatalogue::AddStop(std::string_view name, double lat, double lng) {
-    auto& ref = stops_.emplace_back(std::string(name), lat, lng, stops_.size());
-    std::string_view stop_sw = ref.stop_name;
-    stopname_to_stop_[stop_sw] = &ref;
-    stopname_to_buses_[stop_sw];
+    auto& ref = stops_.emplace_back(std::string(name), lat, lng, static_cast<domain::StopId>(stops_.size()));
+    stop_ids_.Add(ref.stop_name);
+    stop_bus_index_ = {};
+    bus_stats_.clear();
+}
+
+void TransportCatalogue::BuildStopBusIndex() {
+    // маршруты перебираются по возрастанию названия, тогда списки остановок получаются
+    // отсортированными без сортировки каждого
+    std::vector<domain::BusId> sorted_buses(buses_.size());
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        sorted_buses[i] = static_cast<domain::BusId>(i);
+    }
+    std::sort(sorted_buses.begin(), sorted_buses.end(), [this](domain::BusId lhs, domain::BusId rhs) {
+        return buses_[lhs].bus < buses_[rhs].bus;
+    });
+    
+    // последний маршрут, записанный для остановки, - чтобы не записать маршрут дважды
+    constexpr domain::BusId NO_BUS = std::numeric_limits<domain::BusId>::max();
+    std::vector<domain::BusId> last_buses(stops_.size(), NO_BUS);
     
+    domain::StopBusIndex index;
+    index.offsets.assign(stops_.size() + 1, 0);
+    for (const domain::BusId bus_id : sorted_buses) {
+        for (auto stop : buses_[bus_id].stops) {
+            if (last_buses[stop->stop_id] != bus_id) {
+                last_buses[stop->stop_id] = bus_id;
+                ++index.offsets[stop->stop_id + 1];
+            }
+        }
+    }
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        index.offsets[stop + 1] += index.offsets[stop];
+    }
+    
+    index.bus_ids.resize(index.offsets.back());
+    std::vector<std::uint32_t> positions(index.offsets.begin(), index.offsets.end() - 1);
+    last_buses.assign(stops_.size(), NO_BUS);
+    for (const domain::BusId bus_id : sorted_buses) {
+        for (auto stop : buses_[bus_id].stops) {
+            if (last_buses[stop->stop_id] != bus_id) {
+                last_buses[stop->stop_id] = bus_id;
+                index.bus_ids[positions[stop->stop_id]++] = bus_id;
+            }
+        }
+    }
+    
+    stop_bus_index_ = std::move(index);
+}
+
+void TransportCatalogue::SetStopBusIndex(domain::StopBusIndex stop_bus_index) {
+    const auto& offsets = stop_bus_index.offsets;
+    if (offsets.size() != stops_.size() + 1 || offsets.front() != 0 || offsets.back() != stop_bus_index.bus_ids.size()
+        || !std::is_sorted(offsets.begin(), offsets.end())) {
+        throw std::invalid_argument("Stop bus index doesn't match the stops");
+    }
+    for (const domain::BusId bus_id : stop_bus_index.bus_ids) {
+        if (bus_id >= buses_.size()) {
+            throw std::invalid_argument("Stop bus index doesn't match the buses");
+        }
+    }
+    stop_bus_index_ = std::move(stop_bus_index);
+}
+
+const domain::StopBusIndex& TransportCatalogue::GetStopBusIndex() const {
+    CheckStopBusIndex();
+    return stop_bus_index_;
+}
+
+void TransportCatalogue::CheckStopBusIndex() const {
+    if (stop_bus_index_.offsets.size() != stops_.size() + 1) {
+        throw std::logic_error("Stop bus index is not built");
+    }
 }
 
 void TransportCatalogue::SetDistance(domain::Stop* departure_stop, domain::Stop* arrival_stop, double distance) {
-	auto key_pair = std::make_pair(departure_stop, arrival_stop);
-	
-	distance_[key_pair] = distance;
+	distance_[MakeDistanceKey(departure_stop->stop_id, arrival_stop->stop_id)] = distance;
 }
 
 void TransportCatalogue::AddRoutingSetting(int wait_time, int bus_velocity)  {
@@ -53,77 +156,378 @@ void TransportCatalogue::AddRoutingSetting(int wait_time, int bus_velocity)  {
     routing_setting_.bus_velocity = bus_velocity;
 }
 
+void TransportCatalogue::AddRoutingSetting(const domain::RoutingSetting& routing_setting)  {
+    routing_setting_ = routing_setting;
+}
+
 void TransportCatalogue::InitRouterGraph() {
-    router_graph_ = graph::DirectedWeightedGraph<double>(stops_.size());
+    size_t vertex_count = stops_.size();
+    
+    if (routing_setting_.graph_model == domain::GraphModel::RIDE_VERTICES) {
+        /// у кругового маршрута одна цепочка вершин "в автобусе", у некругового - по одной на каждое направление
+        for (auto& bus : buses_) {
+            vertex_count += bus.round_trip ? bus.stops.size() : bus.stops.size() * 2;
+        }
+    }
+    
+    router_graph_ = graph::DirectedWeightedGraph<double>(vertex_count);
 }
 
 void TransportCatalogue::AddEdgeInRouterGraph() {
+    if (routing_setting_.graph_model == domain::GraphModel::RIDE_VERTICES) {
+        AddRideEdgesInRouterGraph();
+    } else {
+        AddStopPairEdgesInRouterGraph();
+    }
+}
+
+double TransportCatalogue::GetRoadDistance(domain::Stop* from, domain::Stop* to) const {
+    auto distance = GetDistance(from, to);
+    if (!distance) {
+        distance = GetDistance(to, from);
+    }
+    return distance.value();
+}
+
+void TransportCatalogue::ResolveBusDistances(domain::Bus& bus) const {
+    // расстояния ищутся по паре остановок один раз, дальше перегоны маршрута читаются подряд
+    const size_t segment_count = bus.stops.empty() ? 0 : bus.stops.size() - 1;
+    bus.distances.resize(segment_count);
+    bus.back_distances.resize(segment_count);
+    for (size_t i = 0; i < segment_count; ++i) {
+        bus.distances[i] = GetRoadDistance(bus.stops[i], bus.stops[i + 1]);
+        bus.back_distances[i] = GetRoadDistance(bus.stops[i + 1], bus.stops[i]);
+    }
+}
+
+double TransportCatalogue::GetBusVelocity() const {
     const double to_m = 1000;
     const double to_min = 60;
-    double convert_bus_velocity = routing_setting_.bus_velocity * to_m /to_min;
-    graph::Edge<double> added_edge;
+    return routing_setting_.bus_velocity * to_m /to_min;
+}
+
+void TransportCatalogue::AddRideEdgesInRouterGraph() {
+    /// вершины "в автобусе" нумеруются подряд по маршрутам, поэтому начало цепочек каждого маршрута известно заранее
+    std::vector<graph::VertexId> first_ride_vertices;
+    first_ride_vertices.reserve(buses_.size());
+    graph::VertexId ride_vertex = stops_.size();
     for (auto& bus : buses_) {
-        added_edge.bus = &bus;
-        for (size_t i = 0; i < bus.stops.size() - 1; ++i) {
-            double sum_distance = 0;
-            double sum_back_distance = 0;
-            for (size_t j = i + 1; j < bus.stops.size(); ++j) {
-                added_edge.from = bus.stops.at(i)->stop_id;
-                added_edge.to = bus.stops.at(j)->stop_id;
-
-                auto distance = GetDistance(bus.stops.at(j-1), bus.stops.at(j));
-
-                if (!distance) {
-                    distance = GetDistance(bus.stops.at(j), bus.stops.at(j-1));
-                }
-								
-                sum_distance += distance.value();
+        first_ride_vertices.push_back(ride_vertex);
+        ride_vertex += bus.round_trip ? bus.stops.size() : bus.stops.size() * 2;
+    }
+    
+    AddEdgesInParallel([this, &first_ride_vertices](size_t bus_index, std::vector<graph::Edge<double>>& edges) {
+        MakeRideEdges(buses_[bus_index], first_ride_vertices[bus_index], edges);
+    });
+}
+
+void TransportCatalogue::MakeRideEdges(domain::Bus& bus, graph::VertexId first_vertex, std::vector<graph::Edge<double>>& edges) const {
+    const double convert_bus_velocity = GetBusVelocity();
+    
+    /// Добавляет цепочку вершин "в автобусе" для остановок stops в порядке их следования,
+    /// distances[i] - расстояние от stops[i] до stops[i + 1]
+    auto add_ride_chain = [&](const std::vector<domain::Stop*>& stops, const std::vector<double>& distances) {
+        for (size_t i = 0; i < stops.size(); ++i) {
+            const graph::VertexId current = first_vertex + i;
+            
+            // посадка: ожидание автобуса на остановке
+            edges.push_back({stops[i]->stop_id, current, static_cast<double>(routing_setting_.wait_time), 0, &bus});
+            // высадка
+            edges.push_back({current, stops[i]->stop_id, 0, 0, nullptr});
+            // проезд до следующей остановки
+            if (i + 1 < stops.size()) {
+                const double time = distances[i] / convert_bus_velocity;
+                edges.push_back({current, current + 1, time, 1, &bus});
+            }
+        }
+        first_vertex += stops.size();
+    };
+    
+    add_ride_chain(bus.stops, bus.distances);
+    if (!bus.round_trip) {
+        std::vector<domain::Stop*> back_stops(bus.stops.rbegin(), bus.stops.rend());
+        add_ride_chain(back_stops, std::vector<double>(bus.back_distances.rbegin(), bus.back_distances.rend()));
+    }
+}
+
+void TransportCatalogue::AddStopPairEdgesInRouterGraph() {
+    AddEdgesInParallel([this](size_t bus_index, std::vector<graph::Edge<double>>& edges) {
+        MakeStopPairEdges(buses_[bus_index], edges);
+    });
+}
+
+void TransportCatalogue::MakeStopPairEdges(domain::Bus& bus, std::vector<graph::Edge<double>>& edges) const {
+    const double convert_bus_velocity = GetBusVelocity();
+    graph::Edge<double> added_edge;
+    added_edge.bus = &bus;
+    for (size_t i = 0; i + 1 < bus.stops.size(); ++i) {
+        double sum_distance = 0;
+        double sum_back_distance = 0;
+        for (size_t j = i + 1; j < bus.stops.size(); ++j) {
+            added_edge.from = bus.stops.at(i)->stop_id;
+            added_edge.to = bus.stops.at(j)->stop_id;
+
+            sum_distance += bus.distances[j - 1];
+							
+            added_edge.weight = sum_distance /  convert_bus_velocity + routing_setting_.wait_time;
+            
+            added_edge.stops_count = j - i;
+							
+            edges.push_back(added_edge);
+							
+            if (!bus.round_trip) {
+                added_edge.from = bus.stops.at(j)->stop_id;
+                added_edge.to = bus.stops.at(i)->stop_id;
 								
-                added_edge.weight = sum_distance /  convert_bus_velocity + routing_setting_.wait_time;
-                
-                added_edge.stops_count = j - i;
+                sum_back_distance += bus.back_distances[j - 1];
 								
-                router_graph_.AddEdge(added_edge);
+                added_edge.weight = sum_back_distance /   convert_bus_velocity + routing_setting_.wait_time;
 								
-                if (!bus.round_trip) {
-                    added_edge.from = bus.stops.at(j)->stop_id;
-                    added_edge.to = bus.stops.at(i)->stop_id;
-									
-                    auto distance_back = GetDistance(bus.stops.at(j), bus.stops.at(j-1));
-                    if (distance_back && distance_back != distance) {
-                        sum_back_distance += distance_back.value();
-                    }
-                    else {
-                        sum_back_distance += distance.value();
-                    }
-									
-                    added_edge.weight = sum_back_distance /   convert_bus_velocity + routing_setting_.wait_time;
-									
-                    router_graph_.AddEdge(added_edge);
+                edges.push_back(added_edge);
+            }
+            
+        }
+    }
+}
+
+template <typename MakeBusEdges>
+void TransportCatalogue::AddEdgesInParallel(MakeBusEdges make_bus_edges) {
+    const size_t bus_count = buses_.size();
+    const size_t thread_count = parallel::GetThreadCount(bus_count);
+    
+    /// каждый поток заполняет свой буфер для непрерывного диапазона маршрутов
+    std::vector<std::vector<graph::Edge<double>>> buffers(thread_count);
+    parallel::ForEachRange(bus_count, thread_count, [&](size_t thread_index, size_t begin, size_t end) {
+        for (size_t bus_index = begin; bus_index < end; ++bus_index) {
+            make_bus_edges(bus_index, buffers[thread_index]);
+        }
+    });
+    
+    /// буферы сливаются в порядке маршрутов, поэтому номера ребер не зависят от числа потоков
+    for (auto& buffer : buffers) {
+        for (const auto& edge : buffer) {
+            router_graph_.AddEdge(edge);
+        }
+    }
+}
+
+std::vector<domain::RoutePattern> TransportCatalogue::GetRoutePatterns() const {
+    std::vector<domain::RoutePattern> patterns;
+    patterns.reserve(buses_.size() * 2);
+    
+    for (auto& bus : buses_) {
+        if (bus.stops.empty()) {
+            continue;
+        }
+        const size_t stop_count = bus.stops.size();
+        
+        domain::RoutePattern& pattern = patterns.emplace_back();
+        pattern.bus = &bus;
+        pattern.stops.reserve(stop_count);
+        pattern.distances.reserve(stop_count);
+        for (size_t i = 0; i < stop_count; ++i) {
+            pattern.stops.push_back(bus.stops[i]->stop_id);
+            pattern.distances.push_back(i == 0 ? 0 : pattern.distances.back() + bus.distances[i - 1]);
+        }
+        
+        if (!bus.round_trip) {
+            // обратное направление: остановки с конца, перегон от stops[i + 1] до stops[i]
+            domain::RoutePattern& back_pattern = patterns.emplace_back();
+            back_pattern.bus = &bus;
+            back_pattern.stops.reserve(stop_count);
+            back_pattern.distances.reserve(stop_count);
+            for (size_t k = 0; k < stop_count; ++k) {
+                const size_t i = stop_count - 1 - k;
+                back_pattern.stops.push_back(bus.stops[i]->stop_id);
+                back_pattern.distances.push_back(k == 0 ? 0 : back_pattern.distances.back() + bus.back_distances[i]);
+            }
+        }
+    }
+    return patterns;
+}
+
+domain::GeoBound TransportCatalogue::GetGeoBound() const {
+    domain::GeoBound geo_bound;
+    geo_bound.stop_vertex_count = stops_.size();
+    geo_bound.wait_time = routing_setting_.wait_time;
+    geo_bound.vertex_points.reserve(router_graph_.GetVertexCount());
+    for (auto& stop : stops_) {
+        geo_bound.vertex_points.push_back(stop.geo_point);
+    }
+    
+    /// наименьшее отношение длины перегона по дорогам к расстоянию по прямой
+    std::optional<double> min_ratio;
+    auto update_ratio = [&](domain::Stop* from, domain::Stop* to, double road_distance) {
+        const double geo_distance = geo::ComputeHaversineDistance(from->geo_point, to->geo_point);
+        if (geo_distance > 0) {
+            const double ratio = road_distance / geo_distance;
+            min_ratio = min_ratio ? std::min(*min_ratio, ratio) : ratio;
+        }
+    };
+    
+    for (auto& bus : buses_) {
+        for (size_t i = 0; i + 1 < bus.stops.size(); ++i) {
+            update_ratio(bus.stops[i], bus.stops[i + 1], bus.distances[i]);
+            if (!bus.round_trip) {
+                update_ratio(bus.stops[i + 1], bus.stops[i], bus.back_distances[i]);
+            }
+        }
+        
+        // вершины "в автобусе" лежат в точках своих остановок (в том же порядке, что и в AddRideEdgesInRouterGraph)
+        if (routing_setting_.graph_model == domain::GraphModel::RIDE_VERTICES) {
+            for (auto stop : bus.stops) {
+                geo_bound.vertex_points.push_back(stop->geo_point);
+            }
+            if (!bus.round_trip) {
+                for (auto it = bus.stops.rbegin(); it != bus.stops.rend(); ++it) {
+                    geo_bound.vertex_points.push_back((*it)->geo_point);
                 }
-                
             }
         }
     }
+    
+    if (min_ratio && routing_setting_.bus_velocity > 0) {
+        geo_bound.min_time_per_meter = *min_ratio / GetBusVelocity();
+    }
+    return geo_bound;
+}
+
+void TransportCatalogue::FreezeRouterGraph() {
+    router_graph_.Freeze();
 }
 
 void TransportCatalogue::InitDeserializeRouterGraph(std::vector<graph::Edge<double>> edges, std::vector<std::vector<size_t>> incidence_lists) {
-  router_graph_ = graph::DirectedWeightedGraph<double>(incidence_lists , edges);
-//   router_graph_.InitEdges(edges); 
+  router_graph_ = graph::DirectedWeightedGraph<double>(std::move(incidence_lists), std::move(edges));
+  router_graph_.Freeze();
+}
+
+std::vector<graph::EdgeWeightChange<double>> TransportCatalogue::UpdateDistance(domain::Stop* departure_stop, domain::Stop* arrival_stop, 
+                                                                               double distance) {
+    SetDistance(departure_stop, arrival_stop, distance);
+    
+    // расстояние в обратную сторону берется из прямого, если оно не задано, поэтому
+    // затронуты маршруты, проходящие перегон в любом направлении
+    // такой маршрут проходит через остановку отправления
+    CheckStopBusIndex();
+    std::vector<size_t> bus_indexes;
+    const auto& offsets = stop_bus_index_.offsets;
+    for (size_t k = offsets[departure_stop->stop_id]; k < offsets[departure_stop->stop_id + 1]; ++k) {
+        const domain::BusId i = stop_bus_index_.bus_ids[k];
+        const auto& stops = buses_[i].stops;
+        for (size_t j = 1; j < stops.size(); ++j) {
+            if ((stops[j - 1] == departure_stop && stops[j] == arrival_stop) 
+                || (stops[j - 1] == arrival_stop && stops[j] == departure_stop)) {
+                bus_indexes.push_back(i);
+                break;
+            }
+        }
+    }
+    // ребра маршрутов обновляются в порядке номеров маршрутов
+    std::sort(bus_indexes.begin(), bus_indexes.end());
+    // перегоны и длина маршрута изменились только у маршрутов, проходящих перегон
+    const bool has_bus_stats = bus_stats_.size() == buses_.size();
+    for (const size_t i : bus_indexes) {
+        ResolveBusDistances(buses_[i]);
+        if (has_bus_stats) {
+            bus_stats_[i] = ComputeBusStat(buses_[i]);
+        }
+    }
+    return UpdateBusEdges(bus_indexes);
+}
+
+std::vector<graph::EdgeWeightChange<double>> TransportCatalogue::UpdateRoutingSetting(int wait_time, int bus_velocity) {
+    routing_setting_.wait_time = wait_time;
+    routing_setting_.bus_velocity = bus_velocity;
+    
+    std::vector<size_t> bus_indexes(buses_.size());
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        bus_indexes[i] = i;
+    }
+    return UpdateBusEdges(bus_indexes);
+}
+
+size_t TransportCatalogue::GetBusEdgeCount(const domain::Bus& bus) const {
+    const size_t stop_count = bus.stops.size();
+    const size_t direction_count = bus.round_trip ? 1 : 2;
+    if (stop_count == 0) {
+        return 0;
+    }
+    if (routing_setting_.graph_model == domain::GraphModel::RIDE_VERTICES) {
+        // посадка и высадка на каждой остановке и проезд между соседними
+        return (3 * stop_count - 1) * direction_count;
+    }
+    return stop_count * (stop_count - 1) / 2 * direction_count;
+}
+
+std::vector<graph::EdgeWeightChange<double>> TransportCatalogue::UpdateBusEdges(const std::vector<size_t>& bus_indexes) {
+    std::vector<graph::EdgeWeightChange<double>> changes;
+    // граф не строится для RAPTOR
+    if (router_graph_.GetEdgeCount() == 0) {
+        return changes;
+    }
+    
+    // ребра и вершины "в автобусе" маршрутов идут подряд в порядке buses_, их начало считается заново
+    graph::EdgeId first_edge = 0;
+    graph::VertexId first_ride_vertex = stops_.size();
+    size_t bus_index = 0;
+    std::vector<graph::Edge<double>> edges;
+    for (const size_t updated_index : bus_indexes) {
+        for (; bus_index < updated_index; ++bus_index) {
+            first_edge += GetBusEdgeCount(buses_[bus_index]);
+            first_ride_vertex += buses_[bus_index].round_trip ? buses_[bus_index].stops.size() : buses_[bus_index].stops.size() * 2;
+        }
+        
+        domain::Bus& bus = buses_[updated_index];
+        edges.clear();
+        if (routing_setting_.graph_model == domain::GraphModel::RIDE_VERTICES) {
+            MakeRideEdges(bus, first_ride_vertex, edges);
+        } else {
+            MakeStopPairEdges(bus, edges);
+        }
+        
+        if (first_edge + edges.size() > router_graph_.GetEdgeCount()) {
+            throw std::logic_error("Router graph doesn't match the buses");
+        }
+        for (size_t i = 0; i < edges.size(); ++i) {
+            const graph::EdgeId edge_id = first_edge + i;
+            const auto edge = router_graph_.GetEdge(edge_id);
+            if (edge.from != edges[i].from || edge.to != edges[i].to) {
+                throw std::logic_error("Router graph doesn't match the buses");
+            }
+            const double old_weight = edge.weight;
+            if (old_weight != edges[i].weight) {
+                changes.push_back({edge_id, old_weight});
+                router_graph_.SetEdgeWeight(edge_id, edges[i].weight);
+            }
+        }
+    }
+    return changes;
 }
 
 domain::Stop* TransportCatalogue::FindStop(const std::string& name) {
-    if (stopname_to_stop_.count(name) != 0) {
-        return stopname_to_stop_.at(name);
+    auto id = stop_ids_.Find(name);
+    if (id) {
+        return &stops_[*id];
     }
     else {
         return nullptr;
     }
 }
 
-domain::Bus* TransportCatalogue::FindBus(const std::string_view& name) const {
-    if (busname_to_bus_.count(name) != 0) {
-        return busname_to_bus_.at(name);
+domain::Bus* TransportCatalogue::FindBus(const std::string_view& name) {
+    auto id = bus_ids_.Find(name);
+    if (id) {
+        return &buses_[*id];
+    }
+    else {
+        return nullptr;
+    }
+}
+
+const domain::Bus* TransportCatalogue::FindBus(const std::string_view& name) const {
+    auto id = bus_ids_.Find(name);
+    if (id) {
+        return &buses_[*id];
     }
     else {
         return nullptr;
@@ -131,39 +535,49 @@ domain::Bus* TransportCatalogue::FindBus(const std::string_view& name) const {
 }
 
 std::optional<domain::BusStat> TransportCatalogue::GetBusStat(const std::string_view& bus_name) const {
-    auto find_bus = FindBus(bus_name);
-	if (find_bus == nullptr) {
+    auto bus_id = bus_ids_.Find(bus_name);
+	if (!bus_id) {
 		return {};
 	}
-	
+	if (bus_stats_.size() != buses_.size()) {
+		throw std::logic_error("Bus stats are not built");
+	}
+	return bus_stats_[*bus_id];
+}
+
+void TransportCatalogue::BuildBusStats() {
+    std::vector<domain::BusStat> bus_stats(buses_.size());
+    // маршруты независимы, каждый поток пишет только в свой диапазон
+    parallel::ForEachRange(buses_.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            bus_stats[i] = ComputeBusStat(buses_[i]);
+        }
+    });
+    bus_stats_ = std::move(bus_stats);
+}
+
+domain::BusStat TransportCatalogue::ComputeBusStat(const domain::Bus& bus) const {
 	domain::BusStat bus_stat;
-	bus_stat.stop_count = find_bus->stops.size();
-    bus_stat.unique_stop_count = find_bus->uni_stops;
+	if (bus.stops.empty()) {
+		return bus_stat;
+	}
+	
+	bus_stat.stop_count = bus.stops.size();
+    bus_stat.unique_stop_count = bus.uni_stops;
 	
 	double coordinate_lengh = 0;
         
         /// Считаем длину маршрута по контейнеру расстояний и по координатам
-	for (size_t i = 0; i < find_bus->stops.size() - 1; ++i) {
-		coordinate_lengh += geo::ComputeDistance(find_bus->stops[i]->geo_point, find_bus->stops[i+1]->geo_point);
+	for (size_t i = 0; i < bus.stops.size() - 1; ++i) {
+		coordinate_lengh += geo::ComputeDistance(bus.stops[i]->geo_point, bus.stops[i+1]->geo_point);
 
-		if (distance_.count(std::make_pair(find_bus->stops[i], find_bus->stops[i+1]))) {
-                bus_stat.route_length += distance_.at(std::make_pair(find_bus->stops[i], find_bus->stops[i+1]));
-            }
-            else {
-                bus_stat.route_length += distance_.at(std::make_pair(find_bus->stops[i+1], find_bus->stops[i]));
-            }
+		bus_stat.route_length += bus.distances[i];
         }
         
         /// Если маршрут не круговой, то по контейнеру расстояний проходим другими парами, чтобы найти отличные расстояния в разных направлениях
-        if (!(find_bus->round_trip)) {
-            for (size_t i = find_bus->stops.size() - 1; i > 0; --i) {
-				
-                if (distance_.count(std::make_pair(find_bus->stops[i], find_bus->stops[i-1]))) {
-                    bus_stat.route_length += distance_.at(std::make_pair(find_bus->stops[i], find_bus->stops[i-1]));
-                }
-                else {
-                    bus_stat.route_length += distance_.at(std::make_pair(find_bus->stops[i-1], find_bus->stops[i]));
-                }
+        if (!(bus.round_trip)) {
+            for (size_t i = bus.stops.size() - 1; i > 0; --i) {
+                bus_stat.route_length += bus.back_distances[i-1];
             }
             
             coordinate_lengh *= 2; /// географическую длину увеличиваем в двое
@@ -176,24 +590,27 @@ std::optional<domain::BusStat> TransportCatalogue::GetBusStat(const std::string_
 }
 
 std::optional<std::vector<std::string_view>> TransportCatalogue::GetBusesByStop(const std::string_view& stop_name) const {
-    if (stopname_to_buses_.count(stop_name) == 0) {
+    auto stop_id = stop_ids_.Find(stop_name);
+    if (!stop_id) {
 		return {};
 	}
 	
-	auto buses_list = &stopname_to_buses_.at(stop_name);
-	
-	std::vector<std::string_view> sort_buses(std::move_iterator(buses_list->begin()), std::move_iterator(buses_list->end()));
-		std::sort(sort_buses.begin(), sort_buses.end(), [](const auto& lhs, const auto& rhs) {
-            return lhs < rhs;
-			});
-		return sort_buses;
+	// маршруты в индексе уже упорядочены по названию, названия нужны только для ответа
+	CheckStopBusIndex();
+	const auto& offsets = stop_bus_index_.offsets;
+	std::vector<std::string_view> sort_buses;
+	sort_buses.reserve(offsets[*stop_id + 1] - offsets[*stop_id]);
+	for (size_t k = offsets[*stop_id]; k < offsets[*stop_id + 1]; ++k) {
+		sort_buses.push_back(buses_[stop_bus_index_.bus_ids[k]].bus);
+	}
+	return sort_buses;
 }
 
 
 std::optional<double> TransportCatalogue::GetDistance(domain::Stop* stop1, domain::Stop* stop2) const{
-    KeyStops stops_pair = std::make_pair(stop1, stop2);
-    if (distance_.count(stops_pair)) {
-        return distance_.at(stops_pair);
+    auto it = distance_.find(MakeDistanceKey(stop1->stop_id, stop2->stop_id));
+    if (it != distance_.end()) {
+        return it->second;
     } else {
         return {};
     }
@@ -250,8 +667,9 @@ std::vector<const domain::Stop*> TransportCatalogue::GetSortStopsToRender() cons
 std::unordered_set<const domain::Stop*> TransportCatalogue::GetStopsToRender() const {
     std::unordered_set<const domain::Stop*> stops;
     
+    CheckStopBusIndex();
     for (auto& stop : stops_) {
-        if ( !stopname_to_buses_.at(stop.stop_name).empty()) {
+        if (stop_bus_index_.offsets[stop.stop_id + 1] != stop_bus_index_.offsets[stop.stop_id]) {
             stops.insert(&stop);
         }
     }
@@ -263,9 +681,13 @@ graph::DirectedWeightedGraph<double>& TransportCatalogue::GetGraph() {
     return router_graph_;
 }
 
-// size_t TransportCatalogue::GetStopId(std::string_view stop_name) const {
-//     return stopname_to_stop_.at(stop_name)->stop_id;
-// }
+size_t TransportCatalogue::GetStopId(std::string_view stop_name) const {
+    return stop_ids_.At(stop_name);
+}
+
+std::optional<size_t> TransportCatalogue::FindStopId(std::string_view stop_name) const {
+    return stop_ids_.Find(stop_name);
+}
 
 
 double TransportCatalogue::GetWaitTime() const {
@@ -282,7 +704,7 @@ const std::vector<std::string_view> TransportCatalogue::GetAllStopName() const {
 }
 
 const geo::Coordinates TransportCatalogue::GetStopCoordinate(std::string_view stop_name) const {
-    return stopname_to_stop_.at(stop_name)->geo_point;
+    return stops_[stop_ids_.At(stop_name)].geo_point;
 }
 
 const std::vector<std::string_view> TransportCatalogue::GetAllBusesName() const {
@@ -297,16 +719,17 @@ const std::vector<std::string_view> TransportCatalogue::GetAllBusesName() const
     return bus_names;
 }
 
-const bool TransportCatalogue::IsRoundTrip(std::string_view name) const {
-    return busname_to_bus_.at(name)->round_trip;
+bool TransportCatalogue::IsRoundTrip(std::string_view name) const {
+    return buses_[bus_ids_.At(name)].round_trip;
 }
 
 const std::vector<int> TransportCatalogue::GetStopsNumToBus(std::string_view name) const {
     std::vector<int> stops_num;
     
-    stops_num.reserve(busname_to_bus_.at(name)->stops.size());
+    const domain::Bus& bus = buses_[bus_ids_.At(name)];
+    stops_num.reserve(bus.stops.size());
     
-    for (auto& stop : busname_to_bus_.at(name)->stops) {
+    for (auto& stop : bus.stops) {
         stops_num.push_back(static_cast<int>(stop->stop_id));
     }
     
@@ -325,15 +748,14 @@ std::vector<std::string_view> TransportCatalogue::GetStopsNameFromId(std::vector
 }
 
 std::vector<std::tuple<int, int, double>> TransportCatalogue::GetDistances() const {
-	std::vector<std::tuple<int, int, double>> map_distances;
+	// ключ - номер остановки отправления в старших разрядах, поэтому порядок ключей - порядок номеров остановок
+	std::vector<std::pair<std::uint64_t, double>> sorted_distances(distance_.begin(), distance_.end());
+	std::sort(sorted_distances.begin(), sorted_distances.end());
 	
-	for (auto stop_from : stops_) {
-	  for (auto stop_to : stops_) {
-		auto distance = GetDistance(stopname_to_stop_.at(stop_from.stop_name), stopname_to_stop_.at(stop_to.stop_name));
-		if (distance.has_value()) {
-            map_distances.push_back(std::make_tuple(static_cast<int>(stop_from.stop_id), static_cast<int>(stop_to.stop_id), distance.value()));
-		}
-	  }
+	std::vector<std::tuple<int, int, double>> map_distances;
+	map_distances.reserve(sorted_distances.size());
+	for (const auto& [key, distance] : sorted_distances) {
+		map_distances.emplace_back(static_cast<int>(key >> 32), static_cast<int>(key & 0xFFFFFFFFu), distance);
 	}
 	
 	return map_distances;
@@ -346,3 +768,15 @@ domain::RoutingSetting TransportCatalogue::GetRoutingSetting() const{
 std::string_view TransportCatalogue::GetStopNameFromId(size_t id) const {
     return stops_.at(id).stop_name;
 }
+
+domain::Stop* TransportCatalogue::GetStopById(domain::StopId id) {
+    return &stops_.at(id);
+}
+
+domain::Bus* TransportCatalogue::GetBusById(domain::BusId id) {
+    return &buses_.at(id);
+}
+
+size_t TransportCatalogue::GetStopCount() const {
+    return stops_.size();
+}
@@ -21,12 +21,18 @@
 #include <algorithm>
 #include <unordered_set>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
 
 #include <iostream>
 
 
 #include "domain.h"
 #include "graph.h"
+#include "name_index.h"
+#include "parallel.h"
 
 namespace catalog {
 /*!
@@ -37,8 +43,6 @@ namespace catalog {
  * автобусных маршрутах.
  */
 
-	using KeyStops = std::pair<domain::Stop*, domain::Stop*>;
-
     class TransportCatalogue {
     public:
 		
@@ -54,10 +58,43 @@ namespace catalog {
          * @param stops_name Список остановок маршрута
          * @param flag Флаг является ли маршрут кольцевым
          * 
+         * Расстояния между соседними остановками маршрута берутся в момент добавления,
+         * поэтому они задаются до маршрута
+         * 
          * @return None
         */
         void AddBus(std::string_view name, std::vector<std::string_view>& stops_name, bool flag);
         
+        /// То же, что и AddBus по названиям остановок, но остановки заданы номерами (загрузка из базы)
+        void AddBus(std::string_view name, const std::vector<domain::StopId>& stop_ids, bool flag);
+        
+        /*!
+         * Задает расписание маршрута
+         * 
+         * @param name Имя маршрута
+         * @param timetable Время отправления (мин. от начала суток) с каждой из GetTripStopCount() остановок рейса, 
+         * рейсы подряд; внутри рейса время не убывает
+         * 
+         * @return None
+        */
+        void SetBusTimetable(std::string_view name, std::vector<int> timetable);
+        
+        /*!
+         * Возвращает расписание маршрута
+         * 
+         * @param name Имя маршрута
+         * 
+         * @return время отправления с каждой остановки рейса, рейсы подряд (пусто - расписания нет)
+        */
+        const std::vector<int>& GetBusTimetable(std::string_view name) const;
+        
+        /*!
+         * Возвращает маршруты, для которых задано расписание
+         * 
+         * @return вектор указателей на маршруты с расписанием
+        */
+        std::vector<const domain::Bus*> GetBusesWithTimetable() const;
+        
         /*!
          * Добавляет новую остановку в каталог
          * 
@@ -90,6 +127,15 @@ namespace catalog {
         */
         void AddRoutingSetting(int wait_time, int bus_velocity);
         
+        /*!
+         * Добавляет все настройки маршрута, включая алгоритм поиска и способ построения графа
+         * 
+         * @param routing_setting настройки маршрута
+         * 
+         * @return None
+        */
+        void AddRoutingSetting(const domain::RoutingSetting& routing_setting);
+        
         /*!
          * Инициализируем граф маршрутов
          * 
@@ -98,14 +144,23 @@ namespace catalog {
         void InitRouterGraph();
         
         /*!
-         * Заполняем граф маршрутов ребрами (ребро - время (в минутах) 
+         * Заполняем граф маршрутов ребрами согласно routing_setting.graph_model:
+         * STOP_PAIRS - ребро на каждую пару остановок маршрута (время (в минутах)
          * за которое можно добраться с остановки "from" до остановки "to"
-         * на маршруте "bus", включая время ожидания автобуса)
+         * на маршруте "bus", включая время ожидания автобуса);
+         * RIDE_VERTICES - ребра посадки (время ожидания), проезда до следующей остановки и высадки
          * 
          * @return None
         */
         void AddEdgeInRouterGraph();
         
+        /*!
+         * Переводит заполненный граф маршрутов в компактное неизменяемое представление (CSR)
+         * 
+         * @return None
+        */
+        void FreezeRouterGraph();
+        
         /*!
          * Инициализируем и заполняем граф из десериализованным графом 
 		 *
@@ -113,6 +168,29 @@ namespace catalog {
         */
         void InitDeserializeRouterGraph(std::vector<graph::Edge<double>> edges, std::vector<std::vector<size_t>> incidence_lists);
         
+        /*!
+         * Изменяет расстояние между остановками и веса ребер графа маршрутов, проходящих
+         * через этот перегон (граф не перестраивается)
+         * 
+         * @param departure_stop остановка отправления
+         * @param arrival_stop остановка прибытия
+         * @param distance новое расстояние между остановками
+         * 
+         * @return измененные ребра с их прежними весами
+        */
+        std::vector<graph::EdgeWeightChange<double>> UpdateDistance(domain::Stop* departure_stop, domain::Stop* arrival_stop, double distance);
+        
+        /*!
+         * Изменяет время ожидания и скорость автобуса и пересчитывает веса всех ребер графа маршрутов
+         * (граф не перестраивается)
+         * 
+         * @param wait_time время ожидания автобуса на остановке в минутах
+         * @param bus_velocity средняя скорость автобуса в км/ч
+         * 
+         * @return измененные ребра с их прежними весами
+        */
+        std::vector<graph::EdgeWeightChange<double>> UpdateRoutingSetting(int wait_time, int bus_velocity);
+        
         /*!
          * Ищет информацию об остановке в каталоге
          * 
@@ -129,7 +207,9 @@ namespace catalog {
          * 
          * @return Ссылку на структуру с описанием маршрута, если маршрут не найден - nullptr
         */
-        domain::Bus* FindBus(const std::string_view& name) const;
+        domain::Bus* FindBus(const std::string_view& name);
+        
+        const domain::Bus* FindBus(const std::string_view& name) const;
         
         /*!
          * Преобразует данные о маршруте "name" в общее кол-во остановок, 
@@ -142,6 +222,14 @@ namespace catalog {
          */
         std::optional<domain::BusStat> GetBusStat(const std::string_view& bus_name) const;
         
+        /*!
+         * Считает статистику всех маршрутов (параллельно), после чего запрос Bus - чтение готового значения
+         * 
+         * Вызывается один раз после добавления всех маршрутов: добавление остановки или маршрута
+         * делает статистику недействительной
+         */
+        void BuildBusStats();
+        
         /*!
          * Получает список маршрутов проходящих через заданную остановку
          * 
@@ -152,6 +240,24 @@ namespace catalog {
          */
         std::optional<std::vector<std::string_view>> GetBusesByStop(const std::string_view& stop_name) const;
         
+        /*!
+         * Строит по маршрутам каталога индекс "остановка -> маршруты", отсортированные по названию
+         * 
+         * Вызывается один раз после добавления всех маршрутов: добавление остановки или маршрута
+         * делает индекс недействительным
+         */
+        void BuildStopBusIndex();
+        
+        /*!
+         * Устанавливает загруженный из базы индекс "остановка -> маршруты"
+         * 
+         * @throw std::invalid_argument индекс не соответствует остановкам и маршрутам каталога
+         */
+        void SetStopBusIndex(domain::StopBusIndex stop_bus_index);
+        
+        /// Индекс "остановка -> маршруты" для сохранения в базу
+        const domain::StopBusIndex& GetStopBusIndex() const;
+        
         /*!
          * Возвращает расстояние между остановками
          * 
@@ -211,6 +317,29 @@ namespace catalog {
         * 
         */
         graph::DirectedWeightedGraph<double>& GetGraph();
+        
+        /*!
+        * Возвращает данные для нижней оценки времени в пути между вершинами графа маршрутов
+        * 
+        * Время проезда перегона не меньше расстояния по прямой, умноженного на min_time_per_meter,
+        * а любой маршрут от остановки до другой вершины начинается с ожидания автобуса,
+        * поэтому оценка не превышает время любого маршрута
+        * 
+        * @return координаты вершин графа и наименьшее время проезда метра по прямой
+        * 
+        */
+        domain::GeoBound GetGeoBound() const;
+        
+        /*!
+        * Возвращает последовательности остановок маршрутов для поиска RAPTOR
+        * 
+        * Кольцевой маршрут дает одну последовательность, некольцевой - две (туда и обратно),
+        * расстояния считаются так же, как веса ребер графа маршрутов STOP_PAIRS
+        * 
+        * @return последовательности остановок с расстояниями от первой остановки
+        * 
+        */
+        std::vector<domain::RoutePattern> GetRoutePatterns() const;
        
         /*!
         * Возвращает Id остановки
@@ -220,6 +349,9 @@ namespace catalog {
         */
         size_t GetStopId(std::string_view stop_name) const;
         
+        /// Id остановки по ее имени, std::nullopt - такой остановки нет
+        std::optional<size_t> FindStopId(std::string_view stop_name) const;
+        
         /*!
         * Возвращает имя остановки по ее Id
         * 
@@ -228,6 +360,20 @@ namespace catalog {
         */
         std::string_view GetStopNameFromId(size_t id) const;
         
+        /// Остановка по ее номеру, std::out_of_range - такой остановки нет
+        domain::Stop* GetStopById(domain::StopId id);
+        
+        /// Маршрут по его номеру, std::out_of_range - такого маршрута нет
+        domain::Bus* GetBusById(domain::BusId id);
+        
+        /*!
+        * Возвращает количество остановок (остановки - первые вершины графа маршрутов)
+        * 
+        * @return количество остановок
+        * 
+        */
+        size_t GetStopCount() const;
+        
         /*!
         * Возвращает время ожидания автобуса
         * 
@@ -271,7 +417,7 @@ namespace catalog {
         * false - если не кольцевой
         * 
         */
-       const bool IsRoundTrip(std::string_view name) const;
+       bool IsRoundTrip(std::string_view name) const;
        
         /*!
         * Вектор id остановок маршрута
@@ -294,9 +440,10 @@ namespace catalog {
        std::vector<std::string_view> GetStopsNameFromId(std::vector<int> ids) const;
        
        /*!
-        * Возвращает map дистанций с ключем в виде пары id остановок
+        * Возвращает заданные расстояния между остановками по возрастанию id остановки отправления,
+        * затем прибытия (время пропорционально количеству расстояний, а не квадрату числа остановок)
 		* 
-        * @return map дистанций
+        * @return кортежи: id остановки отправления, id остановки прибытия, расстояние
         * 
         */
        std::vector<std::tuple<int, int, double>> GetDistances() const;
@@ -310,32 +457,66 @@ namespace catalog {
        domain::RoutingSetting GetRoutingSetting() const;
     private:
     
-        std::deque<domain::Stop> stops_; /// Список всех остановок
-        std::unordered_map<std::string_view, domain::Stop*> stopname_to_stop_; /// Контейнер для быстрого поиска остановки по названию
+        std::deque<domain::Stop> stops_; /// Список всех остановок, номер остановки - ее позиция
+        NameIndex stop_ids_;             /// Номера остановок по названию
         
-        std::unordered_map<std::string_view, std::unordered_set<std::string_view>> stopname_to_buses_; /// set имен маршрутов, от имени остановки
+        domain::StopBusIndex stop_bus_index_; /// Номера маршрутов, проходящих через остановку (по возрастанию названия)
  
-        std::deque<domain::Bus> buses_;    /// Список всех маршрутов
-        std::unordered_map<std::string_view, domain::Bus*> busname_to_bus_; /// Контейнер для быстрого поиска маршрутов по названию
-        
-        /// Хэшер для пары указателей
-        struct pair_hash {
-            size_t operator() (const std::pair<domain::Stop*, domain::Stop*> &p) const {
-                auto h1 = std::hash<const void*>{}(p.first);
-                auto h2 = std::hash<const void*>{}(p.second);
-                
-                return h1 * 47 + h2;
-            }
-        };
+        std::deque<domain::Bus> buses_;  /// Список всех маршрутов, номер маршрута - его позиция
+        NameIndex bus_ids_;              /// Номера маршрутов по названию
+        std::vector<domain::BusStat> bus_stats_; /// Статистика маршрутов по номеру маршрута
         
-        using KeyStops = std::pair<domain::Stop*, domain::Stop*>;
+        /// Ключ расстояния: номера остановок отправления и прибытия в одном числе
+        static std::uint64_t MakeDistanceKey(domain::StopId from, domain::StopId to) {
+            return static_cast<std::uint64_t>(from) << 32 | to;
+        }
         
         /// Контейнер с дистанциями между остановками
-        std::unordered_map<KeyStops, double, pair_hash> distance_; 
+        std::unordered_map<std::uint64_t, double> distance_; 
         
        
        domain::RoutingSetting routing_setting_;             // 
        graph::DirectedWeightedGraph<double> router_graph_;
        
+       /// Расстояние по дороге между соседними остановками (если в обратную сторону расстояние не задано - берется прямое)
+       double GetRoadDistance(domain::Stop* from, domain::Stop* to) const;
+       
+       /// Заполняет расстояния между соседними остановками маршрута в обе стороны
+       void ResolveBusDistances(domain::Bus& bus) const;
+       
+       /// Длина и кривизна маршрута по расстояниям и координатам остановок
+       domain::BusStat ComputeBusStat(const domain::Bus& bus) const;
+       
+       /// Проверяет, что индекс "остановка -> маршруты" построен для текущих остановок и маршрутов
+       void CheckStopBusIndex() const;
+       
+       /// Средняя скорость автобуса в м/мин
+       double GetBusVelocity() const;
+       
+       /// Заполнение графа ребрами для каждой пары остановок маршрута
+       void AddStopPairEdgesInRouterGraph();
+       
+       /// Заполнение графа ребрами посадки, проезда и высадки через вершины "в автобусе"
+       void AddRideEdgesInRouterGraph();
+       
+       /// Ребра для каждой пары остановок маршрута bus
+       void MakeStopPairEdges(domain::Bus& bus, std::vector<graph::Edge<double>>& edges) const;
+       
+       /// Ребра посадки, проезда и высадки маршрута bus, вершины "в автобусе" нумеруются с first_vertex
+       void MakeRideEdges(domain::Bus& bus, graph::VertexId first_vertex, std::vector<graph::Edge<double>>& edges) const;
+       
+       /// Количество ребер маршрута bus в графе маршрутов (ребра маршрутов идут подряд в порядке buses_)
+       size_t GetBusEdgeCount(const domain::Bus& bus) const;
+       
+       /// Пересчитывает веса ребер маршрутов с номерами bus_indexes (по возрастанию) и возвращает измененные ребра
+       std::vector<graph::EdgeWeightChange<double>> UpdateBusEdges(const std::vector<size_t>& bus_indexes);
+       
+       /*!
+        * Параллельно (по потокам на непрерывные диапазоны маршрутов) строит ребра маршрутов
+        * вызовом make_bus_edges(bus_index, edges) и добавляет их в граф в порядке маршрутов
+        */
+       template <typename MakeBusEdges>
+       void AddEdgesInParallel(MakeBusEdges make_bus_edges);
+       
     };
 }
@@ -1,23 +1,222 @@
 #include "transport_router.h"
 
+#include <stdexcept>
+
 using namespace transport_router;
 
-TransportRouter::TransportRouter(const TransportRouter::Graph& graph)
-    : router_(graph)
+TransportRouter::TransportRouter(const TransportRouter::Graph& graph, const domain::RoutingSetting& routing_setting, 
+                                 PrecomputedData precomputed)
 {
+    if (precomputed.route_patterns || routing_setting.router_type == domain::RouterType::RAPTOR) {
+        raptor_router_ = std::make_unique<raptor::RaptorRouter>(
+            precomputed.route_patterns ? std::move(*precomputed.route_patterns) : std::vector<domain::RoutePattern>{}, routing_setting);
+    }
+    if (routing_setting.router_type != domain::RouterType::RAPTOR) {
+        router_ = MakeRouter(graph, routing_setting, std::move(precomputed));
+        // таблицы путей и иерархия отвечают на запросы о паре вершин, а изохроне нужен
+        // поиск, который сам остановится по времени в пути
+        isochrone_router_ = std::make_unique<graph::DijkstraRouter<double>>(graph);
+    }
+}
+
+std::unique_ptr<graph::BaseRouter<double>> TransportRouter::MakeRouter(const TransportRouter::Graph& graph, const domain::RoutingSetting& routing_setting, 
+                                                                       PrecomputedData precomputed) {
+    switch (routing_setting.router_type) {
+        case domain::RouterType::DIJKSTRA:
+            return std::make_unique<graph::DijkstraRouter<double>>(graph);
+        case domain::RouterType::CONTRACTION_HIERARCHY:
+            if (precomputed.hierarchy) {
+                return std::make_unique<graph::ContractionHierarchyRouter<double>>(graph, std::move(*precomputed.hierarchy));
+            }
+            return std::make_unique<graph::ContractionHierarchyRouter<double>>(graph);
+        case domain::RouterType::BLOCKED_FLOYD_WARSHALL:
+            if (routing_setting.route_table_precision == domain::RouteTablePrecision::FLOAT) {
+                if (precomputed.compact_routes_table) {
+                    return std::make_unique<graph::BlockedFloydRouter<double, float>>(graph, std::move(*precomputed.compact_routes_table));
+                }
+                return std::make_unique<graph::BlockedFloydRouter<double, float>>(graph);
+            }
+            if (precomputed.routes_table) {
+                return std::make_unique<graph::BlockedFloydRouter<double>>(graph, std::move(*precomputed.routes_table));
+            }
+            return std::make_unique<graph::BlockedFloydRouter<double>>(graph);
+        case domain::RouterType::A_STAR:
+            // без координат вершин оценка нулевая и поиск совпадает с поиском Дейкстры
+            return std::make_unique<graph::AStarRouter<double, GeoHeuristic>>(graph, 
+                GeoHeuristic{precomputed.geo_bound ? std::move(*precomputed.geo_bound) : domain::GeoBound{}});
+        case domain::RouterType::ALT:
+            if (precomputed.landmarks) {
+                return std::make_unique<graph::AStarRouter<double, graph::LandmarkHeuristic<double>>>(graph, 
+                    graph::LandmarkHeuristic<double>(graph, std::move(*precomputed.landmarks)));
+            }
+            return std::make_unique<graph::AStarRouter<double, graph::LandmarkHeuristic<double>>>(graph, 
+                graph::LandmarkHeuristic<double>(graph, static_cast<size_t>(routing_setting.landmark_count)));
+        case domain::RouterType::FLOYD_WARSHALL:
+        default:
+            if (precomputed.routes_internal_data) {
+                return std::make_unique<graph::Router<double>>(graph, std::move(*precomputed.routes_internal_data));
+            }
+            return std::make_unique<graph::Router<double>>(graph);
+    }
+}
+
+double GeoHeuristic::operator()(graph::VertexId vertex, graph::VertexId to) const {
+    if (vertex == to) {
+        return 0;
+    }
+    // с остановки не уехать без ожидания автобуса
+    const double wait_time = vertex < geo_bound.stop_vertex_count ? geo_bound.wait_time : 0;
+    if (geo_bound.min_time_per_meter == 0) {
+        return wait_time;
+    }
+    return wait_time + geo::ComputeHaversineDistance(geo_bound.vertex_points.at(vertex), geo_bound.vertex_points.at(to)) 
+                       * geo_bound.min_time_per_meter;
+}
+
+bool TransportRouter::CanUpdateEdgeWeights(const domain::RoutingSetting& routing_setting) const {
+    return !router_ || routing_setting.router_type == domain::RouterType::A_STAR || router_->CanUpdateEdgeWeights();
+}
+
+void TransportRouter::UpdateEdgeWeights(const std::vector<graph::EdgeWeightChange<double>>& changes, 
+                                        const domain::RoutingSetting& routing_setting, PrecomputedData catalog_data) {
+    // последовательности остановок строятся за один проход по маршрутам
+    if (catalog_data.route_patterns) {
+        raptor_router_ = std::make_unique<raptor::RaptorRouter>(std::move(*catalog_data.route_patterns), routing_setting);
+        catalog_data.route_patterns.reset();
+    }
+    if (!router_) {
+        return;
+    }
+    
+    // оценка A* зависит от скорости и расстояний, она строится заново за один проход по вершинам
+    if (routing_setting.router_type == domain::RouterType::A_STAR) {
+        const Graph& graph = router_->GetGraph();
+        router_ = MakeRouter(graph, routing_setting, std::move(catalog_data));
+        return;
+    }
+    if (!router_->UpdateEdgeWeights(changes)) {
+        throw std::logic_error("Routing engine can't be updated without rebuilding the base");
+    }
+}
+
+const RoutesInternalData* TransportRouter::GetRoutesInternalData() const {
+    auto floyd_router = dynamic_cast<const graph::Router<double>*>(router_.get());
+    if (floyd_router == nullptr) {
+        return nullptr;
+    }
+    return &floyd_router->GetRoutesInternalData();
+}
+
+const HierarchyData* TransportRouter::GetHierarchyData() const {
+    auto hierarchy_router = dynamic_cast<const graph::ContractionHierarchyRouter<double>*>(router_.get());
+    if (hierarchy_router == nullptr) {
+        return nullptr;
+    }
+    return &hierarchy_router->GetHierarchyData();
+}
+
+const RoutesTable* TransportRouter::GetRoutesTable() const {
+    auto blocked_router = dynamic_cast<const graph::BlockedFloydRouter<double>*>(router_.get());
+    if (blocked_router == nullptr) {
+        return nullptr;
+    }
+    return &blocked_router->GetRoutesTable();
+}
+
+const CompactRoutesTable* TransportRouter::GetCompactRoutesTable() const {
+    auto blocked_router = dynamic_cast<const graph::BlockedFloydRouter<double, float>*>(router_.get());
+    if (blocked_router == nullptr) {
+        return nullptr;
+    }
+    return &blocked_router->GetRoutesTable();
+}
+
+std::vector<std::vector<std::optional<double>>> TransportRouter::GetRouteMatrix(const std::vector<graph::VertexId>& from, 
+                                                                                const std::vector<graph::VertexId>& to) const {
+    std::vector<std::vector<std::optional<double>>> matrix(from.size());
+    parallel::ForEachRange(from.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            matrix[i] = router_ ? router_->BuildRouteWeights(from[i], to) : raptor_router_->BuildTimes(from[i], to);
+        }
+    });
+    return matrix;
+}
+
+const LandmarkData* TransportRouter::GetLandmarkData() const {
+    auto alt_router = dynamic_cast<const graph::AStarRouter<double, graph::LandmarkHeuristic<double>>*>(router_.get());
+    if (alt_router == nullptr) {
+        return nullptr;
+    }
+    return &alt_router->GetHeuristic().GetLandmarkData();
+}
+
+std::vector<std::pair<graph::VertexId, double>> TransportRouter::GetIsochrone(graph::VertexId from, double max_time) const {
+    if (!isochrone_router_) {
+        return raptor_router_->BuildReachableTimes(from, max_time);
+    }
+    return isochrone_router_->BuildReachableWeights(from, max_time);
+}
+
+std::tuple<double, std::vector<RouteInfo>> TransportRouter::MakeRoute(const raptor::Journey& journey) {
+    std::vector<RouteInfo> items;
+    items.reserve(journey.legs.size());
+    for (auto& leg : journey.legs) {
+        items.push_back({leg.board_stop, leg.bus, leg.span_count, leg.time});
+    }
+    return std::make_tuple(journey.total_time, std::move(items));
+}
+
+std::vector<std::tuple<double, std::vector<RouteInfo>>> TransportRouter::GetRouteAlternatives(graph::VertexId from, graph::VertexId to) const {
+    if (!raptor_router_) {
+        throw std::logic_error("Route alternatives need stop sequences of buses");
+    }
+    
+    std::vector<std::tuple<double, std::vector<RouteInfo>>> routes;
+    for (const auto& journey : raptor_router_->BuildJourneys(from, to)) {
+        routes.push_back(MakeRoute(journey));
+    }
+    return routes;
 }
 
 std::optional<std::tuple<double, std::vector<RouteInfo>>> TransportRouter::GetRouter(graph::VertexId from, graph::VertexId to) const {
-    auto router = router_.BuildRoute(from, to);
+    if (!router_) {
+        auto journey = raptor_router_->BuildJourney(from, to);
+        if (!journey) {
+            return {};
+        }
+        return MakeRoute(*journey);
+    }
+    
+    auto router = router_->BuildRoute(from, to);
     
     if (!router) {
         return {};
     }
     double total_time = router.value().weight;
+    const Graph& graph = router_->GetGraph();
     std::vector<RouteInfo> items;
+    items.reserve(router.value().edges.size());
     
+    // В модели RIDE_VERTICES одна поездка - это ребро посадки (stops_count == 0), ребра проезда
+    // и ребро высадки (bus == nullptr); в модели STOP_PAIRS поездка - одно ребро
+    std::optional<RouteInfo> boarded;
     for (auto& edge : router.value().edges) {
-        const graph::Edge route_part = router_.GetGraph().GetEdge(edge);
+        const graph::Edge<double> route_part = graph.GetEdge(edge);
+        
+        if (route_part.bus == nullptr) {
+            if (boarded) {
+                items.push_back(*boarded);
+                boarded.reset();
+            }
+            continue;
+        }
+        
+        if (boarded) {
+            boarded->span_count += route_part.stops_count;
+            boarded->time += route_part.weight;
+            continue;
+        }
+        
         RouteInfo item;
         
         item.wait_stop = route_part.from;
@@ -25,8 +224,12 @@ std::optional<std::tuple<double, std::vector<RouteInfo>>> TransportRouter::GetRo
         item.span_count = route_part.stops_count;
         item.time = route_part.weight;
         
-        items.push_back(item);
+        if (route_part.stops_count == 0) {
+            boarded = item;
+        } else {
+            items.push_back(item);
+        }
     }
     
-    return std::make_tuple(total_time, items);
+    return std::make_tuple(total_time, std::move(items));
 }
@@ -10,11 +10,20 @@
  */
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "blocked_floyd_router.h"
+#include "astar_router.h"
+#include "landmarks.h"
+#include "raptor_router.h"
+#include "parallel.h"
 #include "transport_catalogue.h"
 #include "domain.h"
 
@@ -24,22 +33,120 @@ namespace transport_router {
 
     struct RouteInfo {
         size_t wait_stop;
-        domain::Bus* bus;
+        const domain::Bus* bus;
         int span_count;
         double time;
     };
     
+    using RoutesInternalData = graph::Router<double>::RoutesInternalData;
+    using HierarchyData = graph::ContractionHierarchyData<double>;
+    using RoutesTable = graph::RoutesTable<double>;
+    using CompactRoutesTable = graph::RoutesTable<float>;
+    using LandmarkData = graph::LandmarkData<double>;
+    
+    /// Заранее посчитанные (загруженные из базы) данные движков поиска маршрутов
+    struct PrecomputedData {
+        std::optional<RoutesInternalData> routes_internal_data;   ///< Таблица путей для FLOYD_WARSHALL
+        std::optional<HierarchyData> hierarchy;                   ///< Иерархия сжатия для CONTRACTION_HIERARCHY
+        std::optional<RoutesTable> routes_table;                  ///< Плоская таблица путей для BLOCKED_FLOYD_WARSHALL
+        std::optional<CompactRoutesTable> compact_routes_table;   ///< То же с весами во float (RouteTablePrecision::FLOAT)
+        std::optional<domain::GeoBound> geo_bound;                ///< Координаты вершин для эвристики A_STAR (не хранятся в базе)
+        std::optional<LandmarkData> landmarks;                    ///< Ориентиры и веса путей до них для ALT
+        std::optional<std::vector<domain::RoutePattern>> route_patterns;  ///< Последовательности остановок для RAPTOR и RouteAlternatives (не хранятся в базе)
+    };
+    
+    /// Нижняя оценка времени в пути между вершинами графа по расстоянию по прямой
+    struct GeoHeuristic {
+        domain::GeoBound geo_bound;
+        
+        double operator()(graph::VertexId vertex, graph::VertexId to) const;
+    };
+    
     class TransportRouter {
     private:
         using Graph = graph::DirectedWeightedGraph<double>;
         
     public:
-        TransportRouter(const Graph& graph);
+        /// precomputed - заранее посчитанные данные выбранного алгоритма, если их нет - они строятся заново
+        TransportRouter(const Graph& graph, const domain::RoutingSetting& routing_setting = {}, 
+                        PrecomputedData precomputed = {});
         
         std::optional<std::tuple<double, std::vector<RouteInfo>>> GetRouter(graph::VertexId from, graph::VertexId to) const;
         
+        /*!
+         * Парето-оптимальные маршруты по времени в пути и числу пересадок (один поиск RAPTOR)
+         * 
+         * Требует последовательностей остановок в PrecomputedData::route_patterns
+         * 
+         * @return маршруты по возрастанию числа пересадок, пусто - маршрута нет
+         */
+        std::vector<std::tuple<double, std::vector<RouteInfo>>> GetRouteAlternatives(graph::VertexId from, graph::VertexId to) const;
+        
+        /*!
+         * Время в пути между всеми парами остановок from x to
+         * 
+         * Для каждой остановки from выполняется один поиск (или чтение строки таблицы путей),
+         * строки матрицы считаются параллельно
+         * 
+         * @return матрица from.size() x to.size(), std::nullopt - маршрута нет
+         */
+        std::vector<std::vector<std::optional<double>>> GetRouteMatrix(const std::vector<graph::VertexId>& from, 
+                                                                       const std::vector<graph::VertexId>& to) const;
+        
+        /*!
+         * Вершины графа, до которых из from можно доехать не дольше max_time (изохрона)
+         * 
+         * Один поиск Дейкстры, который прекращается, как только время в пути превышает max_time;
+         * для RAPTOR - раунды RAPTOR, отбрасывающие маршруты дольше max_time
+         * 
+         * @return вершины и время в пути до них по возрастанию времени
+         */
+        std::vector<std::pair<graph::VertexId, double>> GetIsochrone(graph::VertexId from, double max_time) const;
+        
+        /*!
+         * Может ли выбранный движок учесть изменение весов ребер без построения заново
+         * 
+         * Иерархия сжатия и ориентиры ALT по частям не обновляются, а их построение заново
+         * сравнимо с make_base, поэтому для них изменения нужно вносить в базу
+         */
+        bool CanUpdateEdgeWeights(const domain::RoutingSetting& routing_setting) const;
+        
+        /*!
+         * Учитывает уже внесенные в граф изменения весов ребер
+         * 
+         * Таблицы путей и поиски по графу обновляются на месте, оценка A* строится заново
+         * (сам граф не перестраивается)
+         * 
+         * @param catalog_data данные, которые строятся по каталогу (route_patterns, geo_bound)
+         * @throw std::logic_error движок не может учесть изменения (CanUpdateEdgeWeights() == false)
+         */
+        void UpdateEdgeWeights(const std::vector<graph::EdgeWeightChange<double>>& changes, const domain::RoutingSetting& routing_setting, 
+                               PrecomputedData catalog_data);
+        
+        /// Таблица путей для всех пар остановок, nullptr - если выбранный алгоритм ее не строит
+        const RoutesInternalData* GetRoutesInternalData() const;
+        
+        /// Иерархия сжатия графа, nullptr - если выбранный алгоритм ее не строит
+        const HierarchyData* GetHierarchyData() const;
+        
+        /// Плоская таблица путей для всех пар остановок, nullptr - если выбранный алгоритм ее не строит
+        const RoutesTable* GetRoutesTable() const;
+        
+        /// Плоская таблица путей с весами во float, nullptr - если выбранный алгоритм ее не строит
+        const CompactRoutesTable* GetCompactRoutesTable() const;
+        
+        /// Ориентиры ALT, nullptr - если выбранный алгоритм их не строит
+        const LandmarkData* GetLandmarkData() const;
+        
     private:
-        graph::Router<double> router_;
+        std::unique_ptr<graph::BaseRouter<double>> router_;           ///< Поиск по графу маршрутов (nullptr для RAPTOR)
+        std::unique_ptr<raptor::RaptorRouter> raptor_router_;         ///< Поиск по последовательностям остановок (RAPTOR и RouteAlternatives)
+        std::unique_ptr<graph::DijkstraRouter<double>> isochrone_router_;  ///< Ограниченный поиск по графу маршрутов для изохрон (nullptr для RAPTOR)
+        
+        static std::tuple<double, std::vector<RouteInfo>> MakeRoute(const raptor::Journey& journey);
+        
+        static std::unique_ptr<graph::BaseRouter<double>> MakeRouter(const Graph& graph, const domain::RoutingSetting& routing_setting, 
+                                                                     PrecomputedData precomputed);
     };
 
 }